@@ -4,6 +4,7 @@
 #include "guis/GuiInfoPopup.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/ThreadPool.h"
 #include "views/gamelist/IGameListView.h"
 #include "views/gamelist/ISimpleGameListView.h"
 #include "views/ViewController.h"
@@ -14,8 +15,11 @@
 #include "SystemData.h"
 #include "ThemeData.h"
 #include <pugixml.hpp>
+#include <algorithm>
 #include <fstream>
 #include <cstring>
+#include <iterator>
+#include <thread>
 
 /* Handling the getting, initialization, deinitialization, saving and deletion of
  * a CollectionSystemManager Instance */
@@ -59,6 +63,7 @@ CollectionSystemManager::CollectionSystemManager(Window* window) : mWindow(windo
 	mEditingCollectionSystemData = NULL;
 	mCustomCollectionsBundle = NULL;
 	mRandomCollection = NULL;
+	mRecentGamesLoaded = false;
 }
 
 CollectionSystemManager::~CollectionSystemManager()
@@ -135,6 +140,10 @@ bool CollectionSystemManager::saveCustomCollection(SystemData* sys)
 // loads all Collection Systems
 void CollectionSystemManager::loadCollectionSystems(bool async)
 {
+	// the systems were (re)loaded, the games will be looked up again
+	mRecentGames.clear();
+	mRecentGamesLoaded = false;
+
 	initAutoCollectionSystems();
 	CollectionSystemDecl decl = mCollectionSystemDeclsIndex[CUSTOM_COLL_ID];
 	mCustomCollectionsBundle = createNewCollectionEntry(decl.name, decl, CollectionFlags::NONE);
@@ -178,6 +187,8 @@ void CollectionSystemManager::updateSystemsList()
 {
 	// remove all Collection Systems
 	removeCollectionsFromDisplayedSystems();
+	// load the enabled custom ones that aren't yet, in parallel when possible
+	populateCustomCollections();
 	// add custom enabled ones
 	addEnabledCollectionsToDisplayedSystems(&mCustomCollectionSystemsData, false);
 
@@ -235,17 +246,28 @@ void CollectionSystemManager::refreshCollectionSystems(FileData* file)
 	if (!file->getSystem()->isGameSystem() || file->getType() != GAME)
 		return;
 
-	std::map<std::string, CollectionSystemData> allCollections;
-	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
-	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
+	// kept up to date even when "recent" isn't populated, it is saved for the next start
+	FileData* evicted = updateRecentGames(file);
 
-	for(auto sysDataIt = allCollections.cbegin(); sysDataIt != allCollections.cend(); sysDataIt++)
-	{
+	for(auto sysDataIt = mAutoCollectionSystemsData.cbegin(); sysDataIt != mAutoCollectionSystemsData.cend(); sysDataIt++)
 		updateCollectionSystem(file, sysDataIt->second);
+
+	for(auto sysDataIt = mCustomCollectionSystemsData.cbegin(); sysDataIt != mCustomCollectionSystemsData.cend(); sysDataIt++)
+		updateCollectionSystem(file, sysDataIt->second);
+
+	// the least recently played game made room for this one
+	auto recentIt = mAutoCollectionSystemsData.find("recent");
+	if (evicted && recentIt != mAutoCollectionSystemsData.cend() && recentIt->second.isPopulated)
+	{
+		SystemData* recentSys = recentIt->second.system;
+		const std::unordered_map<std::string, FileData*>& children = recentSys->getRootFolder()->getChildrenByFilename();
+		auto entryIt = children.find(evicted->getFullPath());
+		if (entryIt != children.cend())
+			ViewController::get()->getGameListView(recentSys).get()->remove(entryIt->second, false, false);
 	}
 }
 
-void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionSystemData sysData)
+void CollectionSystemManager::updateCollectionSystem(FileData* file, const CollectionSystemData& sysData)
 {
 	if (sysData.isPopulated)
 	{
@@ -257,69 +279,106 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 		bool found = children.find(key) != children.cend();
 		FileData* rootFolder = curSys->getRootFolder();
 		FileFilterIndex* fileIndex = curSys->getIndex();
-		std::string name = curSys->getName();
+		const std::string& name = curSys->getName();
+		// only looked up (and so created) when an entry is added or removed, like the collection was just opened
+		IGameListView* view = nullptr;
+
+		// the collection stays sorted, so only the entry that changed has to be moved instead of sorting it all again
+		const FileData::SortType sortType = getSortTypeFromString(sysData.decl.defaultSort);
+		const bool sorted = rootFolder->getSortDescription() == sortType.description;
 
 		if (found) {
 			// if we found it, we need to update it
 			FileData* collectionEntry = children.at(key);
-			// remove from index, so we can re-index metadata after refreshing
+			// remove from index, so we can re-index the metadata shared with the source
 			fileIndex->removeFromIndex(collectionEntry);
-			collectionEntry->refreshMetadata();
 			// found and we are removing
-			if (name == "favorites" && file->metadata.get("favorite") == "false") {
-				// need to check if still marked as favorite, if not remove
-				ViewController::get()->getGameListView(curSys).get()->remove(collectionEntry, false, true);
+			if (name == "favorites" && file->metadata.get("favorite") == "false" ||
+				name == "recent" && !isRecentGame(file)) {
+				// need to check if still marked as favorite or played, if not remove
+				view = ViewController::get()->getGameListView(curSys).get();
+				view->remove(collectionEntry, false, false);
 			}
 			else
 			{
 				// re-index with new metadata
 				fileIndex->addToIndex(collectionEntry);
-				ViewController::get()->onFileChanged(collectionEntry, FILE_METADATA_CHANGED);
+				if (sorted)
+				{
+					rootFolder->sortChild(collectionEntry, sortType);
+					ViewController::get()->onFileChanged(collectionEntry, FILE_ADDED);
+				}
+				else
+				{
+					ViewController::get()->onFileChanged(collectionEntry, FILE_METADATA_CHANGED);
+				}
 			}
 		}
 		else
 		{
 			// we didn't find it here - we need to check if we should add it
-			if (name == "recent" && file->metadata.get("playcount") > "0" && includeFileInAutoCollections(file) ||
+			if (name == "recent" && isRecentGame(file) ||
 				name == "favorites" && file->metadata.get("favorite") == "true") {
 				CollectionFileData* newGame = new CollectionFileData(file, curSys);
 				rootFolder->addChild(newGame);
 				fileIndex->addToIndex(newGame);
 				ViewController::get()->onFileChanged(file, FILE_METADATA_CHANGED);
-				ViewController::get()->getGameListView(curSys)->onFileChanged(newGame, FILE_METADATA_CHANGED);
+				view = ViewController::get()->getGameListView(curSys).get();
+				if (sorted)
+				{
+					rootFolder->sortChild(newGame, sortType);
+					view->onFileChanged(newGame, FILE_ADDED);
+				}
 			}
 		}
-		rootFolder->sort(getSortTypeFromString(mCollectionSystemDeclsIndex[name].defaultSort));
-		if (name == "recent")
+
+		// the sort was changed from the gamelist options, restore it the same way loading does
+		// a collection that isn't shown, only populated for lookups, is sorted once it is enabled
+		if (!sorted && sysData.isEnabled)
+		{
+			rootFolder->sort(sortType);
+			ViewController::get()->onFileChanged(rootFolder, FILE_SORTED);
+		}
+
+		// an enabled collection's view was made with the systems list already
+		if (name == "recent" && sysData.isEnabled)
 		{
-			trimCollectionCount(rootFolder, LAST_PLAYED_MAX, false);
-			ViewController::get()->onFileChanged(rootFolder, FILE_METADATA_CHANGED);
 			// Force re-calculation of cursor position
 			ViewController::get()->getGameListView(curSys)->setViewportTop(TextListComponent<FileData>::REFRESH_LIST_CURSOR_POS);
 		}
-		else
-			ViewController::get()->onFileChanged(rootFolder, FILE_SORTED);
 	}
 }
 
 void CollectionSystemManager::trimCollectionCount(FileData* rootFolder, int limit, bool shuffle)
 {
 	SystemData* curSys = rootFolder->getSystem();
-	while ((int)rootFolder->getChildrenListToDisplay().size() > limit)
-	{
-		std::vector<FileData*> games = rootFolder->getFilesRecursive(GAME, true);
-		if (shuffle)
-			std::shuffle(games.begin(), games.end(), SystemData::sURNG);
+	int excess = (int)rootFolder->getChildrenListToDisplay().size() - limit;
+	if (excess <= 0)
+		return;
 
-		CollectionFileData* gameToRemove = (CollectionFileData*)games.back();
-		ViewController::get()->getGameListView(curSys).get()->remove(gameToRemove, false, false);
+	std::vector<FileData*> games;
+	if (shuffle)
+	{
+		games = curSys->getRandomGames(excess, [](FileData*) { return true; });
 	}
+	else
+	{
+		// the last ones displayed
+		games = rootFolder->getFilesRecursive(GAME, true);
+		games.erase(games.begin(), games.end() - Math::min(excess, (int)games.size()));
+	}
+
+	for (auto gameIt = games.cbegin(); gameIt != games.cend(); gameIt++)
+		ViewController::get()->getGameListView(curSys).get()->remove(*gameIt, false, false);
+
 	ViewController::get()->onFileChanged(rootFolder, FILE_REMOVED);
 }
 
 // deletes all collection files from collection systems related to the source file
 void CollectionSystemManager::deleteCollectionFiles(FileData* file)
 {
+	removeRecentGame(file);
+
 	// collection files use the full path as key, to avoid clashes
 	std::string key = file->getFullPath();
 	// find games in collection systems
@@ -806,17 +865,18 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name,
 }
 
 void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sourceSystem, FileData* rootFolder,
-	FileFilterIndex* index, std::map<std::string, std::map<std::string, int>> mapsForRandomColl, int defaultValue)
+	FileFilterIndex* index, const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl, int defaultValue)
 {
 
 	int gamesForSourceSystem = defaultValue;
 	for (auto& m : mapsForRandomColl)
 	{
 		// m.first unused
-		std::map<std::string, int> collMap = m.second;
-		if (collMap.find(sourceSystem->getFullName()) != collMap.end())
+		const std::map<std::string, int>& collMap = m.second;
+		auto maxIt = collMap.find(sourceSystem->getFullName());
+		if (maxIt != collMap.cend())
 		{
-			int maxForSys = collMap[sourceSystem->getFullName()];
+			int maxForSys = maxIt->second;
 			// we won't add more than the max and less than 0
 			gamesForSourceSystem = Math::max(Math::min(RANDOM_SYSTEM_MAX, maxForSys), 0);
 			break;
@@ -824,7 +884,7 @@ void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sou
 	}
 
 	// load exclusion collection
-	std::unordered_map<std::string,FileData*> exclusionMap;
+	const std::unordered_map<std::string,FileData*>* exclusionMap = NULL;
 	std::string exclusionCollection = Settings::getInstance()->getString("RandomCollectionExclusionCollection");
 	auto sysDataIt = mCustomCollectionSystemsData.find(exclusionCollection);
 
@@ -834,53 +894,30 @@ void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sou
 			populateCustomCollection(&(sysDataIt->second));
 		}
 
-		exclusionMap = mCustomCollectionSystemsData[exclusionCollection].system->getRootFolder()->getChildrenByFilename();
+		exclusionMap = &(sysDataIt->second.system->getRootFolder()->getChildrenByFilename());
 
 	}
 
 	// we do this to avoid trying to add more games than there are in the system
-	gamesForSourceSystem = Math::min(gamesForSourceSystem, sourceSystem->getRootFolder()->getFilesRecursive(GAME).size());
-
-	int startCount = rootFolder->getFilesRecursive(GAME).size();
-	int endCount = startCount + gamesForSourceSystem;
-	int retryCount = 10;
+	gamesForSourceSystem = Math::min(gamesForSourceSystem, (int)sourceSystem->getRootFolder()->getGameCount());
 
-	for (int iterCount = startCount; iterCount < endCount;)
+	// games picked from another source or in the exclusion collection are skipped
+	const std::unordered_map<std::string,FileData*>& children = rootFolder->getChildrenByFilename();
+	std::vector<FileData*> games = sourceSystem->getRandomGames(Math::max(gamesForSourceSystem, 0), [exclusionMap, &children](FileData* game)
 	{
-		FileData* randomGame = sourceSystem->getRandomGame()->getSourceFileData();
-		CollectionFileData* newGame = NULL;
-
-		if(exclusionMap.find(randomGame->getFullPath()) == exclusionMap.end())
-		{
-			// Not in the exclusion collection
-			newGame = new CollectionFileData(randomGame, newSys);
-			rootFolder->addChild(newGame);
-			index->addToIndex(newGame);
-		}
+		const std::string key = game->getSourceFileData()->getFullPath();
+		return children.find(key) == children.cend() && (!exclusionMap || exclusionMap->find(key) == exclusionMap->cend());
+	});
 
-		if (rootFolder->getFilesRecursive(GAME).size() > iterCount)
-		{
-			// added game, proceed
-			iterCount++;
-			retryCount = 10;
-		}
-		else
-		{
-			// the game already exists in the collection, let's try again
-			LOG(LogDebug) << "Clash: " << randomGame->getName() << " already exists or in exclusion list. Deleting and trying again";
-			delete newGame;
-			retryCount--;
-			if (retryCount == 0)
-			{
-				// we give up. Either we were very unlucky, or all the games in this system are already there.
-				LOG(LogDebug) << "Giving up retrying: cannot add this game. Deleting and moving on.";
-				return;
-			}
-		}
+	for (auto gameIt = games.cbegin(); gameIt != games.cend(); gameIt++)
+	{
+		CollectionFileData* newGame = new CollectionFileData(*gameIt, newSys);
+		rootFolder->addChild(newGame);
+		index->addToIndex(newGame);
 	}
 }
 
-void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<std::string, std::map<std::string, int>> mapsForRandomColl)
+void CollectionSystemManager::populateRandomCollectionFromCollections(const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl)
 {
 	CollectionSystemData* sysData = &mAutoCollectionSystemsData[RANDOM_COLL_ID];
 	SystemData* newSys = sysData->system;
@@ -891,7 +928,7 @@ void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<s
 	// iterate the auto collections map
 	for(auto &c : mAutoCollectionSystemsData)
 	{
-		CollectionSystemData csd = c.second;
+		CollectionSystemData& csd = c.second;
 		// we can't add games from the random collection to the random collection
 		if (csd.decl.type != AUTO_RANDOM)
 		{
@@ -907,7 +944,7 @@ void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<s
 	// iterate the custom collections map
 	for(auto &c : mCustomCollectionSystemsData)
 	{
-		CollectionSystemData csd = c.second;
+		CollectionSystemData& csd = c.second;
 		// collections might not be populated
 		if (!csd.isPopulated)
 			populateCustomCollection(&csd);
@@ -936,6 +973,17 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		std::map<std::string, int> randomCustColl = Settings::getInstance()->getMap("RandomCollectionSystemsCustom");
 		mapsForRandomColl["RandomCollectionSystemsCustom"] = randomCustColl;
 	}
+	else if (sysDecl.type == AUTO_LAST_PLAYED)
+	{
+		// the most recently played games are already known, no need to look at every game
+		loadRecentGames();
+		for (auto recentIt = mRecentGames.cbegin(); recentIt != mRecentGames.cend(); recentIt++)
+		{
+			CollectionFileData* newGame = new CollectionFileData(recentIt->game, newSys);
+			rootFolder->addChild(newGame);
+			index->addToIndex(newGame);
+		}
+	}
 	// Only iterate through game systems, not collections yet
 	for(auto sysIt = SystemData::sSystemVector.cbegin(); sysIt != SystemData::sSystemVector.cend(); sysIt++)
 	{
@@ -946,20 +994,16 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 			{
 				addRandomGames(newSys, *sysIt, rootFolder, index, mapsForRandomColl, DEFAULT_RANDOM_SYSTEM_GAMES);
 			}
-			else
+			else if (sysDecl.type != AUTO_LAST_PLAYED)
 			{
-				std::vector<FileData*> files = (*sysIt)->getRootFolder()->getFilesRecursive(GAME);
-
-				for(auto gameIt = files.cbegin(); gameIt != files.cend(); gameIt++)
+				FileData::FileIterator games((*sysIt)->getRootFolder(), GAME);
+				while(FileData* game = games.next())
 				{
-					bool include = includeFileInAutoCollections(*gameIt);
+					bool include = includeFileInAutoCollections(game);
 					switch(sysDecl.type) {
-						case AUTO_LAST_PLAYED:
-							include = include && (*gameIt)->metadata.get("playcount") > "0";
-							break;
 						case AUTO_FAVORITES:
 							// we may still want to add files we don't want in auto collections in "favorites"
-							include = (*gameIt)->metadata.get("favorite") == "true";
+							include = game->metadata.get("favorite") == "true";
 							break;
 						case AUTO_ALL_GAMES:
 							break;
@@ -972,7 +1016,7 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 
 					if (include)
 					{
-						CollectionFileData* newGame = new CollectionFileData(*gameIt, newSys);
+						CollectionFileData* newGame = new CollectionFileData(game, newSys);
 						rootFolder->addChild(newGame);
 						index->addToIndex(newGame);
 					}
@@ -989,13 +1033,11 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 	if (sysData->isEnabled)
 		rootFolder->sort(getSortTypeFromString(sysDecl.defaultSort));
 
-	if (sysData->isEnabled && (sysDecl.type == AUTO_LAST_PLAYED || sysDecl.type == AUTO_RANDOM))
+	if (sysData->isEnabled && sysDecl.type == AUTO_RANDOM)
 	{
-		int trimValue = LAST_PLAYED_MAX;
-		if (sysDecl.type == AUTO_RANDOM)
-			trimValue = Settings::getInstance()->getInt("RandomCollectionMaxGames");
+		int trimValue = Settings::getInstance()->getInt("RandomCollectionMaxGames");
 		if (trimValue > 0)
-			trimCollectionCount(rootFolder, trimValue, sysDecl.type == AUTO_RANDOM);
+			trimCollectionCount(rootFolder, trimValue, true);
 	}
 
 	sysData->isPopulated = true;
@@ -1003,6 +1045,16 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 
 // populates a Custom Collection System
 void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sysData)
+{
+	populateCustomCollection(sysData, getAllGamesCollection()->getRootFolder()->getChildrenByFilename());
+
+	if(sysData->isPopulated)
+		updateCollectionFolderMetadata(sysData->system);
+}
+
+// adds the games of a Custom Collection System, allFilesMap is the all games collection's read-only index of every game by key
+// only touches sysData, so it can run on worker threads, its folder metadata is left to the caller
+void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sysData, const std::unordered_map<std::string, FileData*>& allFilesMap)
 {
 	SystemData* newSys = sysData->system;
 	CollectionSystemDecl sysDecl = sysData->decl;
@@ -1018,15 +1070,20 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 	FileData* rootFolder = newSys->getRootFolder();
 	FileFilterIndex* index = newSys->getIndex();
 
-	// get Configuration for this Custom System
-	std::ifstream input(path);
-
-	// get all files map
-	std::unordered_map<std::string,FileData*> allFilesMap = getAllGamesCollection()->getRootFolder()->getChildrenByFilename();
+	// get Configuration for this Custom System, one game key per line
+	std::ifstream input(path, std::ios::binary);
+	const std::string config((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
 
 	// iterate list of files in config file
-	for(std::string gameKey; getline(input, gameKey); )
+	for(size_t start = 0; start < config.size(); )
 	{
+		size_t end = config.find('\n', start);
+		if(end == std::string::npos)
+			end = config.size();
+
+		const std::string gameKey = config.substr(start, end - start);
+		start = end + 1;
+
 		std::unordered_map<std::string,FileData*>::const_iterator it = allFilesMap.find(gameKey);
 		if (it != allFilesMap.cend())
 		{
@@ -1040,10 +1097,40 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 		}
 	}
 	rootFolder->sort(getSortTypeFromString(sysDecl.defaultSort));
-	updateCollectionFolderMetadata(newSys);
 	sysData->isPopulated = true;
 }
 
+// populates the enabled custom collections on the thread pool, each one only adds games to its own system
+// the folder metadata is made afterwards on this thread, picking its random game uses the shared SystemData::sURNG
+void CollectionSystemManager::populateCustomCollections()
+{
+	std::vector<CollectionSystemData*> collections;
+	for(auto it = mCustomCollectionSystemsData.begin(); it != mCustomCollectionSystemsData.end(); it++)
+	{
+		if (it->second.isEnabled && !it->second.isPopulated)
+			collections.push_back(&(it->second));
+	}
+
+	// otherwise they are populated one by one as they get displayed
+	if (collections.size() < 2 || std::thread::hardware_concurrency() <= 2 || !Settings::getInstance()->getBool("ThreadedLoading"))
+		return;
+
+	// all of them look their games up in the all games collection, it has to be complete before they start
+	// and is only looked up here, the workers just read its index
+	const std::unordered_map<std::string, FileData*>& allFilesMap = getAllGamesCollection()->getRootFolder()->getChildrenByFilename();
+
+	Utils::ThreadPool pool;
+	for(auto sysData : collections)
+		pool.queueWorkItem([this, sysData, &allFilesMap] { populateCustomCollection(sysData, allFilesMap); });
+	pool.wait();
+
+	for(auto sysData : collections)
+	{
+		if (sysData->isPopulated)
+			updateCollectionFolderMetadata(sysData->system);
+	}
+}
+
 /* Handle System View removal and insertion of Collections */
 void CollectionSystemManager::removeCollectionsFromDisplayedSystems()
 {
@@ -1096,6 +1183,14 @@ void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<s
 					else
 						populateAutoCollection(&(it->second));
 				}
+				else
+				{
+					// populated while disabled, changes to it were not sorted
+					const FileData::SortType sortType = getSortTypeFromString(it->second.decl.defaultSort);
+					FileData* rootFolder = it->second.system->getRootFolder();
+					if (rootFolder->getSortDescription() != sortType.description)
+						rootFolder->sort(sortType);
+				}
 
 				// check if it has its own view
 				if(!it->second.decl.isCustom || themeFolderExists(it->first) || !Settings::getInstance()->getBool("UseCustomCollectionsSystem"))
@@ -1302,6 +1397,192 @@ bool CollectionSystemManager::includeFileInAutoCollections(FileData* file)
 	return file->getName() != "kodi" && file->getSystem()->isGameSystem();
 }
 
+// orders mRecentGames as a heap with the least recently played game on top
+bool CollectionSystemManager::compareRecentGames(const RecentGame& a, const RecentGame& b)
+{
+	return a.lastPlayed > b.lastPlayed;
+}
+
+bool CollectionSystemManager::includeFileInRecentGames(FileData* file)
+{
+	return file->metadata.getInt("playcount") > 0 && includeFileInAutoCollections(file);
+}
+
+bool CollectionSystemManager::isRecentGame(FileData* file) const
+{
+	for (auto recentIt = mRecentGames.cbegin(); recentIt != mRecentGames.cend(); recentIt++)
+	{
+		if (recentIt->game == file)
+			return true;
+	}
+	return false;
+}
+
+// adds file if it is one of the LAST_PLAYED_MAX most recently played games
+// returns the game that doesn't fit anymore, file itself if it wasn't added, NULL if there was still room
+FileData* CollectionSystemManager::pushRecentGame(FileData* file)
+{
+	RecentGame recent = { file->metadata.getTime("lastplayed"), file };
+
+	if ((int)mRecentGames.size() < LAST_PLAYED_MAX)
+	{
+		mRecentGames.push_back(recent);
+		std::push_heap(mRecentGames.begin(), mRecentGames.end(), compareRecentGames);
+		return NULL;
+	}
+
+	if (recent.lastPlayed <= mRecentGames.front().lastPlayed)
+		return file;
+
+	std::pop_heap(mRecentGames.begin(), mRecentGames.end(), compareRecentGames);
+	FileData* evicted = mRecentGames.back().game;
+	mRecentGames.back() = recent;
+	std::push_heap(mRecentGames.begin(), mRecentGames.end(), compareRecentGames);
+	return evicted;
+}
+
+void CollectionSystemManager::removeRecentGame(FileData* file)
+{
+	for (auto recentIt = mRecentGames.begin(); recentIt != mRecentGames.end(); recentIt++)
+	{
+		if (recentIt->game == file)
+		{
+			*recentIt = mRecentGames.back();
+			mRecentGames.pop_back();
+			std::make_heap(mRecentGames.begin(), mRecentGames.end(), compareRecentGames);
+			saveRecentGames();
+			return;
+		}
+	}
+}
+
+// brings the most recently played games up to date after the metadata of file changed
+// returns the game that was pushed out by file, if any
+FileData* CollectionSystemManager::updateRecentGames(FileData* file)
+{
+	loadRecentGames();
+
+	if (!includeFileInRecentGames(file))
+	{
+		removeRecentGame(file);
+		return NULL;
+	}
+
+	const time_t lastPlayed = file->metadata.getTime("lastplayed");
+	for (auto recentIt = mRecentGames.begin(); recentIt != mRecentGames.end(); recentIt++)
+	{
+		if (recentIt->game == file)
+		{
+			// most metadata changes don't touch it
+			if (recentIt->lastPlayed == lastPlayed)
+				return NULL;
+
+			// there are at most LAST_PLAYED_MAX games, rebuilding the heap is as cheap as moving the entry
+			recentIt->lastPlayed = lastPlayed;
+			std::make_heap(mRecentGames.begin(), mRecentGames.end(), compareRecentGames);
+			saveRecentGames();
+			return NULL;
+		}
+	}
+
+	FileData* evicted = pushRecentGame(file);
+	if (evicted == file)
+		return NULL;
+
+	saveRecentGames();
+	return evicted;
+}
+
+// finds a game of a loaded system from its full path, by walking down the folders instead of searching every game
+FileData* CollectionSystemManager::findGameByPath(const std::string& path)
+{
+	for (auto sysIt = SystemData::sSystemVector.cbegin(); sysIt != SystemData::sSystemVector.cend(); sysIt++)
+	{
+		if (!(*sysIt)->isGameSystem() || (*sysIt)->isCollection())
+			continue;
+
+		FileData* folder = (*sysIt)->getRootFolder();
+		const std::string& rootPath = folder->getPath();
+		if (path.size() <= rootPath.size() || path[rootPath.size()] != '/' || path.compare(0, rootPath.size(), rootPath) != 0)
+			continue;
+
+		size_t start = rootPath.size() + 1;
+		while (folder)
+		{
+			size_t end = path.find('/', start);
+			const std::unordered_map<std::string, FileData*>& children = folder->getChildrenByFilename();
+			auto childIt = children.find(path.substr(start, end == std::string::npos ? std::string::npos : end - start));
+			if (childIt == children.cend())
+				break;
+
+			if (end == std::string::npos)
+				return childIt->second->getType() == GAME ? childIt->second : NULL;
+
+			folder = childIt->second->getType() == FOLDER ? childIt->second : NULL;
+			start = end + 1;
+		}
+	}
+	return NULL;
+}
+
+void CollectionSystemManager::loadRecentGames()
+{
+	if (mRecentGamesLoaded)
+		return;
+
+	mRecentGamesLoaded = true;
+	mRecentGames.clear();
+
+	const std::string path = getRecentGamesConfigPath();
+	std::ifstream input(path);
+	if (input.good())
+	{
+		// one game per line, most recently played first
+		std::string gamePath;
+		while (std::getline(input, gamePath) && (int)mRecentGames.size() < LAST_PLAYED_MAX)
+		{
+			FileData* game = findGameByPath(gamePath);
+			if (game && includeFileInRecentGames(game) && !isRecentGame(game))
+				pushRecentGame(game);
+		}
+		return;
+	}
+
+	LOG(LogInfo) << "Couldn't find last played games at " << path << ", looking at all games";
+
+	for (auto sysIt = SystemData::sSystemVector.cbegin(); sysIt != SystemData::sSystemVector.cend(); sysIt++)
+	{
+		if (!(*sysIt)->isGameSystem() || (*sysIt)->isCollection())
+			continue;
+
+		(*sysIt)->getRootFolder()->forEachFile(GAME, [this](FileData* game) {
+			if (includeFileInRecentGames(game))
+				pushRecentGame(game);
+			return true;
+		});
+	}
+
+	saveRecentGames();
+}
+
+void CollectionSystemManager::saveRecentGames()
+{
+	std::vector<RecentGame> games = mRecentGames;
+	std::sort_heap(games.begin(), games.end(), compareRecentGames);
+
+	const std::string path = getRecentGamesConfigPath();
+	std::ofstream configFile(path);
+	if (!configFile.good())
+	{
+		auto const errNo = errno;
+		LOG(LogError) << "Failed to save last played games: " << path << ": " << std::strerror(errNo) << " (" << errNo << ")";
+		return;
+	}
+
+	for (auto gameIt = games.cbegin(); gameIt != games.cend(); gameIt++)
+		configFile << gameIt->game->getFullPath() << "\n";
+}
+
 
 bool CollectionSystemManager::needDoublePress(int presscount) {
 	if (Settings::getInstance()->getBool("DoublePressRemovesFromFavs") && presscount < 2)
@@ -1324,6 +1605,11 @@ std::string getCollectionsFolder()
 	return Utils::FileSystem::getGenericPath(Utils::FileSystem::getHomePath() + "/configs/emulationstation/collections");
 }
 
+std::string getRecentGamesConfigPath()
+{
+	return Utils::FileSystem::getGenericPath(Utils::FileSystem::getHomePath() + "/configs/emulationstation/last_played.cfg");
+}
+
 bool systemSort(SystemData* sys1, SystemData* sys2)
 {
 	std::string name1 = Utils::String::toUpper(sys1->getName());
@@ -2,9 +2,11 @@
 #ifndef ES_APP_COLLECTION_SYSTEM_MANAGER_H
 #define ES_APP_COLLECTION_SYSTEM_MANAGER_H
 
+#include <ctime>
 #include <map>
 #include <SDL_timer.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class FileData;
@@ -83,12 +85,12 @@ public:
 	void updateSystemsList();
 
 	void refreshCollectionSystems(FileData* file);
-	void updateCollectionSystem(FileData* file, CollectionSystemData sysData);
+	void updateCollectionSystem(FileData* file, const CollectionSystemData& sysData);
 	void deleteCollectionFiles(FileData* file);
 	void recreateCollection(SystemData* sysData);
 
-	inline std::map<std::string, CollectionSystemData> getAutoCollectionSystems() { return mAutoCollectionSystemsData; };
-	inline std::map<std::string, CollectionSystemData> getCustomCollectionSystems() { return mCustomCollectionSystemsData; };
+	inline const std::map<std::string, CollectionSystemData>& getAutoCollectionSystems() { return mAutoCollectionSystemsData; };
+	inline const std::map<std::string, CollectionSystemData>& getCustomCollectionSystems() { return mCustomCollectionSystemsData; };
 	inline SystemData* getCustomCollectionsBundle() { return mCustomCollectionsBundle; };
 	inline SystemData* getRandomCollection() { return mRandomCollection; };
 	std::vector<std::string> getUnusedSystemsFromTheme();
@@ -128,9 +130,11 @@ private:
 	SystemData* createNewCollectionEntry(std::string name, CollectionSystemDecl sysDecl, const CollectionFlags flags);
 	void populateAutoCollection(CollectionSystemData* sysData);
 	void populateCustomCollection(CollectionSystemData* sysData);
+	void populateCustomCollection(CollectionSystemData* sysData, const std::unordered_map<std::string, FileData*>& allFilesMap);
+	void populateCustomCollections();
 	void addRandomGames(SystemData* newSys, SystemData* sourceSystem, FileData* rootFolder, FileFilterIndex* index,
-		std::map<std::string, std::map<std::string, int>> mapsForRandomColl, int defaultValue);
-	void populateRandomCollectionFromCollections(std::map<std::string, std::map<std::string, int>> mapsForRandomColl);
+		const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl, int defaultValue);
+	void populateRandomCollectionFromCollections(const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl);
 
 	void removeCollectionsFromDisplayedSystems();
 	void addEnabledCollectionsToDisplayedSystems(std::map<std::string, CollectionSystemData>* colSystemData, bool processRandom);
@@ -145,6 +149,26 @@ private:
 
 	bool includeFileInAutoCollections(FileData* file);
 
+	// the LAST_PLAYED_MAX most recently played games, a heap with the least recently played one on top
+	// kept on disk so "recent" is populated without looking at every game
+	struct RecentGame
+	{
+		time_t lastPlayed;
+		FileData* game;
+	};
+	std::vector<RecentGame> mRecentGames;
+	bool mRecentGamesLoaded;
+
+	static bool compareRecentGames(const RecentGame& a, const RecentGame& b);
+	void loadRecentGames();
+	void saveRecentGames();
+	FileData* updateRecentGames(FileData* file);
+	FileData* pushRecentGame(FileData* file);
+	void removeRecentGame(FileData* file);
+	bool isRecentGame(FileData* file) const;
+	bool includeFileInRecentGames(FileData* file);
+	FileData* findGameByPath(const std::string& path);
+
 	bool needDoublePress(int presscount);
 	int getPressCountInDuration();
 
@@ -156,6 +180,7 @@ private:
 
 std::string getCustomCollectionConfigPath(std::string collectionName);
 std::string getCollectionsFolder();
+std::string getRecentGamesConfigPath();
 bool systemSort(SystemData* sys1, SystemData* sys2);
 
 #endif // ES_APP_COLLECTION_SYSTEM_MANAGER_H
@@ -15,10 +15,13 @@
 #include "SystemData.h"
 #include "VolumeControl.h"
 #include "Window.h"
+#include <algorithm>
 #include <assert.h>
 
 FileData::FileData(FileType type, const std::string& path, SystemEnvironmentData* envData, SystemData* system)
-	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL),
+	mMetadata(new MetaDataList(type == GAME ? GAME_METADATA : FOLDER_METADATA)), metadata(*mMetadata), // metadata is REALLY set in the constructor!
+	mSubtreeGeneration(0), mGameCount(0), mChildGameCount(0), mFilteredIndex(NULL), mFilteredIndexGeneration(0), mFilteredSubtreeGeneration(0), mFilteredMetadataGeneration(0)
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if(metadata.get("name").empty())
@@ -27,6 +30,14 @@ FileData::FileData(FileType type, const std::string& path, SystemEnvironmentData
 	metadata.resetChangedFlag();
 }
 
+FileData::FileData(FileData* sourceFile, SystemData* system)
+	: mType(sourceFile->getType()), mPath(sourceFile->getPath()), mSystem(system), mEnvData(sourceFile->getSystemEnvData()), mSourceFileData(sourceFile), mParent(NULL),
+	metadata(sourceFile->metadata),
+	mSubtreeGeneration(0), mGameCount(0), mChildGameCount(0), mFilteredIndex(NULL), mFilteredIndexGeneration(0), mFilteredSubtreeGeneration(0), mFilteredMetadataGeneration(0)
+{
+	mSystemName = sourceFile->getSystem()->getName();
+}
+
 FileData::~FileData()
 {
 	if(mParent)
@@ -63,18 +74,7 @@ const std::string FileData::getThumbnailPath() const
 
 		// no image, try to use local image
 		if(thumbnail.empty() && Settings::getInstance()->getBool("LocalArt"))
-		{
-			const char* extList[2] = { ".png", ".jpg" };
-			for(int i = 0; i < 2; i++)
-			{
-				if(thumbnail.empty())
-				{
-					std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-					if(Utils::FileSystem::exists(path))
-						thumbnail = path;
-				}
-			}
-		}
+			thumbnail = mEnvData->mLocalMedia.find(mEnvData->mStartPath, getDisplayName(), LocalMediaIndex::IMAGE);
 	}
 
 	return thumbnail;
@@ -97,6 +97,12 @@ const std::vector<FileData*>& FileData::getChildrenListToDisplay() {
 
 	FileFilterIndex* idx = CollectionSystemManager::get()->getSystemToView(mSystem)->getIndex();
 	if (idx->isFiltered()) {
+		const unsigned int metadataGeneration = MetaDataList::getLastGeneration();
+
+		if (idx == mFilteredIndex && idx->getGeneration() == mFilteredIndexGeneration &&
+			mSubtreeGeneration == mFilteredSubtreeGeneration && metadataGeneration == mFilteredMetadataGeneration)
+			return mFilteredChildren;
+
 		mFilteredChildren.clear();
 		for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 		{
@@ -105,6 +111,12 @@ const std::vector<FileData*>& FileData::getChildrenListToDisplay() {
 			}
 		}
 
+		// showFile may refresh the index, so its generation is only read afterwards
+		mFilteredIndex              = idx;
+		mFilteredIndexGeneration    = idx->getGeneration();
+		mFilteredSubtreeGeneration  = mSubtreeGeneration;
+		mFilteredMetadataGeneration = metadataGeneration;
+
 		return mFilteredChildren;
 	}
 	else
@@ -119,11 +131,7 @@ const std::string FileData::getVideoPath() const
 
 	// no video, try to use local video
 	if(video.empty() && Settings::getInstance()->getBool("LocalArt"))
-	{
-		std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-video.mp4";
-		if(Utils::FileSystem::exists(path))
-			video = path;
-	}
+		video = mEnvData->mLocalMedia.find(mEnvData->mStartPath, getDisplayName(), LocalMediaIndex::VIDEO);
 
 	return video;
 }
@@ -134,18 +142,7 @@ const std::string FileData::getMarqueePath() const
 
 	// no marquee, try to use local marquee
 	if(marquee.empty() && Settings::getInstance()->getBool("LocalArt"))
-	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(marquee.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-marquee" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					marquee = path;
-			}
-		}
-	}
+		marquee = mEnvData->mLocalMedia.find(mEnvData->mStartPath, getDisplayName(), LocalMediaIndex::MARQUEE);
 
 	return marquee;
 }
@@ -156,18 +153,7 @@ const std::string FileData::getImagePath() const
 
 	// no image, try to use local image
 	if(image.empty())
-	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(image.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					image = path;
-			}
-		}
-	}
+		image = mEnvData->mLocalMedia.find(mEnvData->mStartPath, getDisplayName(), LocalMediaIndex::IMAGE);
 
 	return image;
 }
@@ -175,24 +161,86 @@ const std::string FileData::getImagePath() const
 std::vector<FileData*> FileData::getFilesRecursive(unsigned int typeMask, bool displayedOnly) const
 {
 	std::vector<FileData*> out;
+
+	forEachFile(typeMask, [&out](FileData* file)
+	{
+		out.push_back(file);
+		return true;
+
+	}, displayedOnly);
+
+	return out;
+}
+
+bool FileData::forEachFile(unsigned int typeMask, const std::function<bool(FileData*)>& visitor, bool displayedOnly) const
+{
 	FileFilterIndex* idx = mSystem->getIndex();
+	const bool filtered = displayedOnly && idx->isFiltered();
 
 	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 	{
-		if((*it)->getType() & typeMask)
+		if(((*it)->getType() & typeMask) && (!filtered || idx->showFile(*it)))
 		{
-			if (!displayedOnly || !idx->isFiltered() || idx->showFile(*it))
-				out.push_back(*it);
+			if(!visitor(*it))
+				return false;
 		}
 
 		if((*it)->getChildren().size() > 0)
 		{
-			std::vector<FileData*> subchildren = (*it)->getFilesRecursive(typeMask, displayedOnly);
-			out.insert(out.cend(), subchildren.cbegin(), subchildren.cend());
+			if(!(*it)->forEachFile(typeMask, visitor, displayedOnly))
+				return false;
 		}
 	}
 
-	return out;
+	return true;
+}
+
+FileData::FileIterator::FileIterator(const FileData* root, unsigned int typeMask)
+	: mRoot(root), mFolder(root), mTypeMask(typeMask), mIndex(0), mDepth(0)
+{
+}
+
+FileData* FileData::FileIterator::next()
+{
+	while(mFolder)
+	{
+		if(mIndex < mFolder->mChildren.size())
+		{
+			FileData* file = mFolder->mChildren[mIndex++];
+
+			// descend first so the following call continues with the children of this file
+			if(file->mChildren.size() > 0)
+			{
+				if(mDepth < MAX_TRACKED_DEPTH)
+					mParentIndices[mDepth] = mIndex;
+
+				mDepth++;
+				mFolder = file;
+				mIndex  = 0;
+			}
+
+			if(file->getType() & mTypeMask)
+				return file;
+		}
+		else if(mFolder == mRoot)
+		{
+			mFolder = NULL;
+		}
+		else
+		{
+			const FileData* folder = mFolder;
+
+			mDepth--;
+			mFolder = folder->mParent;
+
+			if(mDepth < MAX_TRACKED_DEPTH)
+				mIndex = mParentIndices[mDepth];
+			else
+				mIndex = (std::find(mFolder->mChildren.cbegin(), mFolder->mChildren.cend(), folder) - mFolder->mChildren.cbegin()) + 1;
+		}
+	}
+
+	return NULL;
 }
 
 std::string FileData::getKey() {
@@ -225,6 +273,9 @@ void FileData::addChild(FileData* file)
 		mChildrenByFilename[key] = file;
 		mChildren.push_back(file);
 		file->mParent = this;
+		if(file->getType() & GAME)
+			mChildGameCount++;
+		invalidateSubtree((file->getType() & GAME) ? 1 : (int)file->mGameCount);
 	}
 }
 
@@ -239,6 +290,9 @@ void FileData::removeChild(FileData* file)
 		{
 			file->mParent = NULL;
 			mChildren.erase(it);
+			if(file->getType() & GAME)
+				mChildGameCount--;
+			invalidateSubtree((file->getType() & GAME) ? -1 : -(int)file->mGameCount);
 			return;
 		}
 	}
@@ -248,8 +302,46 @@ void FileData::removeChild(FileData* file)
 
 }
 
+FileData* FileData::getGameAt(unsigned int index) const
+{
+	// folders holding nothing but games, like collections, are indexed directly
+	if(mChildGameCount == mChildren.size())
+		return (index < mChildren.size()) ? mChildren[index] : NULL;
+
+	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
+	{
+		if((*it)->getType() & GAME)
+		{
+			if(index == 0)
+				return *it;
+			index--;
+		}
+		else
+		{
+			// the cached counts let whole folders be skipped
+			if(index < (*it)->mGameCount)
+				return (*it)->getGameAt(index);
+			index -= (*it)->mGameCount;
+		}
+	}
+
+	return NULL;
+}
+
+void FileData::invalidateSubtree(int gameCountChange)
+{
+	// a folder is shown when any of its descendants is, so the change is visible to every ancestor
+	for(FileData* folder = this; folder != NULL; folder = folder->mParent)
+	{
+		folder->mSubtreeGeneration++;
+		folder->mGameCount += gameCountChange;
+	}
+}
+
 void FileData::sort(ComparisonFunction& comparator, bool ascending)
 {
+	invalidateSubtree();
+
 	if (ascending)
 	{
 		std::stable_sort(mChildren.begin(), mChildren.end(), comparator);
@@ -270,12 +362,49 @@ void FileData::sort(ComparisonFunction& comparator, bool ascending)
 	}
 }
 
+FileData::SortKeys& FileData::getSortKeys() const
+{
+	if(!mSortKeys)
+		mSortKeys.reset(new SortKeys);
+
+	const unsigned int settingsGeneration = FileSorts::getSortKeyGeneration();
+
+	if((mSortKeys->metadataGeneration != metadata.getGeneration()) || (mSortKeys->settingsGeneration != settingsGeneration))
+	{
+		mSortKeys->metadataGeneration = metadata.getGeneration();
+		mSortKeys->settingsGeneration = settingsGeneration;
+		mSortKeys->valid              = 0;
+	}
+
+	return *mSortKeys;
+}
+
 void FileData::sort(const SortType& type)
 {
 	sort(*type.comparisonFunction, type.ascending);
 	mSortDesc = type.description;
 }
 
+void FileData::sortChild(FileData* file, const SortType& type)
+{
+	assert(file->getParent() == this);
+
+	mChildren.erase(std::find(mChildren.begin(), mChildren.end(), file));
+
+	if (type.ascending)
+	{
+		mChildren.insert(std::upper_bound(mChildren.begin(), mChildren.end(), file, type.comparisonFunction), file);
+	}
+	else
+	{
+		// descending lists are sorted back to front
+		auto it = std::lower_bound(mChildren.rbegin(), mChildren.rend(), file, type.comparisonFunction);
+		mChildren.insert(it.base(), file);
+	}
+
+	invalidateSubtree();
+}
+
 void FileData::launchGame(Window* window)
 {
 	LOG(LogInfo) << "Attempting to launch game...";
@@ -327,14 +456,9 @@ void FileData::launchGame(Window* window)
 }
 
 CollectionFileData::CollectionFileData(FileData* file, SystemData* system)
-	: FileData(file->getSourceFileData()->getType(), file->getSourceFileData()->getPath(), file->getSourceFileData()->getSystemEnvData(), system)
+	: FileData(file->getSourceFileData(), system), mCollectionFileNameGeneration(0)
 {
-	// we use this constructor to create a clone of the filedata, and change its system
-	mSourceFileData = file->getSourceFileData();
-	refreshMetadata();
-	mParent = NULL;
-	metadata = mSourceFileData->metadata;
-	mSystemName = mSourceFileData->getSystem()->getName();
+	// a clone of the source game in another system, only the name shown in the collection is kept here
 }
 
 CollectionFileData::~CollectionFileData()
@@ -354,18 +478,12 @@ FileData* CollectionFileData::getSourceFileData()
 	return mSourceFileData;
 }
 
-void CollectionFileData::refreshMetadata()
-{
-	metadata = mSourceFileData->metadata;
-	mDirty = true;
-}
-
 const std::string& CollectionFileData::getName()
 {
-	if (mDirty) {
-		mCollectionFileName = Utils::String::removeParenthesis(mSourceFileData->metadata.get("name"));
+	if (mCollectionFileNameGeneration != metadata.getGeneration()) {
+		mCollectionFileName = Utils::String::removeParenthesis(metadata.get("name"));
 		mCollectionFileName += " [" + Utils::String::toUpper(mSourceFileData->getSystem()->getName()) + "]";
-		mDirty = false;
+		mCollectionFileNameGeneration = metadata.getGeneration();
 	}
 
 	if (Settings::getInstance()->getBool("CollectionShowSystemInfo"))
@@ -375,7 +493,6 @@ const std::string& CollectionFileData::getName()
 
 // returns Sort Type based on a string description
 FileData::SortType getSortTypeFromString(std::string desc) {
-	std::vector<FileData::SortType> SortTypes = FileSorts::SortTypes;
 	// find it
 	for(unsigned int i = 0; i < FileSorts::SortTypes.size(); i++)
 	{
@@ -4,8 +4,11 @@
 
 #include "utils/FileSystemUtil.h"
 #include "MetaData.h"
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
+class FileFilterIndex;
 class SystemData;
 class Window;
 struct SystemEnvironmentData;
@@ -53,13 +56,39 @@ public:
 	const std::vector<FileData*>& getChildrenListToDisplay();
 	std::vector<FileData*> getFilesRecursive(unsigned int typeMask, bool displayedOnly = false) const;
 
+	// depth-first visit of the descendants matching typeMask, in getFilesRecursive() order
+	// returns false when the visitor stopped early by returning false, the tree must not be changed while visiting
+	bool forEachFile(unsigned int typeMask, const std::function<bool(FileData*)>& visitor, bool displayedOnly = false) const;
+
+	// games below this folder, kept up to date by addChild() and removeChild()
+	inline unsigned int getGameCount() const { return mGameCount; }
+	// the game at position index among getGameCount(), in getFilesRecursive(GAME) order
+	FileData* getGameAt(unsigned int index) const;
+
+	// non-allocating depth-first iterator over the descendants matching typeMask, same order as forEachFile()
+	// usage: FileData::FileIterator it(root, GAME); while(FileData* game = it.next()) ...
+	class FileIterator
+	{
+	public:
+		FileIterator(const FileData* root, unsigned int typeMask);
+		FileData* next(); // returns NULL once all files were visited
+
+	private:
+		static const int MAX_TRACKED_DEPTH = 32; // deeper folders find their position in the parent instead
+
+		const FileData* mRoot;
+		const FileData* mFolder;
+		unsigned int    mTypeMask;
+		size_t          mIndex;
+		int             mDepth;
+		size_t          mParentIndices[MAX_TRACKED_DEPTH];
+	};
+
 	void addChild(FileData* file); // Error if mType != FOLDER
 	void removeChild(FileData* file); //Error if mType != FOLDER
 
 	inline bool isPlaceHolder() { return mType == PLACEHOLDER; };
 
-	virtual inline void refreshMetadata() { return; };
-
 	virtual std::string getKey();
 	const bool isArcadeAsset();
 	inline std::string getFullPath() { return getPath(); };
@@ -87,16 +116,57 @@ public:
 	};
 
 	void sort(const SortType& type);
+	// moves a single child to where sort() would put it, the other children have to be sorted with the same type already
+	void sortChild(FileData* file, const SortType& type);
 	std::string getSortDescription() { return mSortDesc; }
-	MetaDataList metadata;
+
+private:
+	// declared before metadata, which refers to it; collection entries don't have one
+	std::unique_ptr<MetaDataList> mMetadata;
+
+public:
+	// collection entries share the metadata of their source game
+	MetaDataList& metadata;
+
+	// normalized values compared by FileSorts, each one is built on first use and dropped when the metadata
+	// or the sort settings change, see FileSorts::invalidateSortKeys()
+	struct SortKeys
+	{
+		enum Field
+		{
+			NAME      = 1 << 0,
+			GENRE     = 1 << 1,
+			DEVELOPER = 1 << 2,
+			PUBLISHER = 1 << 3,
+			SYSTEM    = 1 << 4,
+			NUMBERS   = 1 << 5  // rating, playcount and players
+		};
+
+		unsigned int metadataGeneration = 0;
+		unsigned int settingsGeneration = 0;
+		unsigned int valid              = 0;
+		std::string  name;
+		std::string  genre;
+		std::string  developer;
+		std::string  publisher;
+		std::string  system;
+		float        rating             = 0;
+		int          playCount          = 0;
+		int          players            = 0;
+	};
+
+	SortKeys& getSortKeys() const;
 
 protected:
+	FileData(FileData* sourceFile, SystemData* system);
+
 	FileData* mSourceFileData;
 	FileData* mParent;
 	std::string mSystemName;
 
 private:
 	void sort(ComparisonFunction& comparator, bool ascending = true);
+	void invalidateSubtree(int gameCountChange = 0);
 	FileType mType;
 	std::string mPath;
 	SystemEnvironmentData* mEnvData;
@@ -105,6 +175,16 @@ private:
 	std::vector<FileData*> mChildren;
 	std::vector<FileData*> mFilteredChildren;
 	std::string mSortDesc;
+
+	// mFilteredChildren is reused until the filters, this folder's subtree or any metadata changes
+	unsigned int mSubtreeGeneration;
+	unsigned int mGameCount;
+	unsigned int mChildGameCount;
+	FileFilterIndex* mFilteredIndex;
+	unsigned int mFilteredIndexGeneration;
+	unsigned int mFilteredSubtreeGeneration;
+	unsigned int mFilteredMetadataGeneration;
+	mutable std::unique_ptr<SortKeys> mSortKeys;
 };
 
 class CollectionFileData : public FileData
@@ -113,13 +193,12 @@ public:
 	CollectionFileData(FileData* file, SystemData* system);
 	~CollectionFileData();
 	const std::string& getName();
-	void refreshMetadata();
 	FileData* getSourceFileData();
 	std::string getKey();
 private:
-	// needs to be updated when metadata changes
+	// rebuilt when the source's metadata changes
 	std::string mCollectionFileName;
-	bool mDirty;
+	unsigned int mCollectionFileNameGeneration;
 };
 
 FileData::SortType getSortTypeFromString(std::string desc);
@@ -5,13 +5,18 @@
 #include "FileData.h"
 #include "Log.h"
 #include "Settings.h"
+#include <algorithm>
 
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
 FileFilterIndex::FileFilterIndex()
-	: filterByFavorites(false), filterByGenre(false), filterByHidden(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false)
+	: filterByFavorites(false), filterByGenre(false), filterByHidden(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false),
+	mIndexKeysStale(false), mGameIdCount(0), mGeneration(1), mFilterResultGeneration(0)
 {
+	for (int i = 0; i < FILTER_TYPE_COUNT; i++)
+		mPostingsBuilt[i] = false;
+
 	clearAllFilters();
 	FilterDataDecl filterDecls[] = {
 		//type 				//allKeys 				//filteredBy 		//filteredKeys 				//primaryKey 	//hasSecondaryKey 	//secondaryKey 	//menuLabel
@@ -34,6 +39,7 @@ FileFilterIndex::~FileFilterIndex()
 
 std::vector<FilterDataDecl>& FileFilterIndex::getFilterDataDecls()
 {
+	refreshIndexKeys();
 	return filterDataDecl;
 }
 
@@ -57,6 +63,9 @@ void FileFilterIndex::importIndex(FileFilterIndex* indexToImport)
 
 	std::vector<IndexImportStructure> indexImportDecl = std::vector<IndexImportStructure>(indexStructDecls, indexStructDecls + sizeof(indexStructDecls) / sizeof(indexStructDecls[0]));
 
+	indexToImport->refreshIndexKeys();
+	mImportedIndexes.push_back(indexToImport);
+
 	for (std::vector<IndexImportStructure>::const_iterator indexesIt = indexImportDecl.cbegin(); indexesIt != indexImportDecl.cend(); ++indexesIt )
 	{
 		for (std::map<std::string, int>::const_iterator sourceIt = (*indexesIt).sourceIndex->cbegin(); sourceIt != (*indexesIt).sourceIndex->cend(); ++sourceIt )
@@ -83,6 +92,20 @@ void FileFilterIndex::resetIndex()
 	clearIndex(favoritesIndexAllKeys);
 	clearIndex(hiddenIndexAllKeys);
 	clearIndex(kidGameIndexAllKeys);
+
+	for (int i = 0; i < FILTER_TYPE_COUNT; i++)
+	{
+		mPostings[i].clear();
+		mPostingsBuilt[i] = false;
+	}
+
+	mGameIds.clear();
+	mFreeGameIds.clear();
+	mGameIdCount = 0;
+	mGeneration++;
+
+	mIndexKeysStale = false;
+	mImportedIndexes.clear();
 }
 
 std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary)
@@ -184,6 +207,32 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 
 void FileFilterIndex::addToIndex(FileData* game)
 {
+	if (mGameIds.find(game) == mGameIds.cend())
+	{
+		unsigned int id;
+
+		if (!mFreeGameIds.empty())
+		{
+			id = mFreeGameIds.back();
+			mFreeGameIds.pop_back();
+		}
+		else
+			id = mGameIdCount++;
+
+		mGameIds[game] = { id, game->metadata.getGeneration(), game->metadata.getGeneration() };
+
+		for (int type = 0; type < FILTER_TYPE_COUNT; type++)
+		{
+			if (mPostingsBuilt[type])
+				addToPostings(game, id, (FilterIndexType)type);
+		}
+
+		mGeneration++;
+	}
+
+	if (mIndexKeysStale)
+		return;
+
 	manageGenreEntryInIndex(game);
 	managePlayerEntryInIndex(game);
 	managePubDevEntryInIndex(game);
@@ -195,6 +244,21 @@ void FileFilterIndex::addToIndex(FileData* game)
 
 void FileFilterIndex::removeFromIndex(FileData* game)
 {
+	auto idIt = mGameIds.find(game);
+	if (idIt != mGameIds.cend())
+	{
+		if (idIt->second.keysGeneration != game->metadata.getGeneration())
+			mIndexKeysStale = true;
+
+		removeFromPostings(idIt->second.id);
+		mFreeGameIds.push_back(idIt->second.id);
+		mGameIds.erase(idIt);
+		mGeneration++;
+	}
+
+	if (mIndexKeysStale)
+		return;
+
 	manageGenreEntryInIndex(game, true);
 	managePlayerEntryInIndex(game, true);
 	managePubDevEntryInIndex(game, true);
@@ -213,10 +277,11 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 	}
 	else
 	{
+		refreshIndexKeys();
 		for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
 			if ((*it).type == type)
 			{
-				FilterDataDecl filterData = (*it);
+				const FilterDataDecl& filterData = (*it);
 				*(filterData.filteredByRef) = values->size() > 0;
 				filterData.currentFilteredKeys->clear();
 				for (std::vector<std::string>::const_iterator vit = values->cbegin(); vit != values->cend(); ++vit ) {
@@ -228,6 +293,7 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 			}
 		}
 	}
+	mGeneration++;
 	return;
 }
 
@@ -235,10 +301,11 @@ void FileFilterIndex::clearAllFilters()
 {
 	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it )
 	{
-		FilterDataDecl filterData = (*it);
+		const FilterDataDecl& filterData = (*it);
 		*(filterData.filteredByRef) = false;
 		filterData.currentFilteredKeys->clear();
 	}
+	mGeneration++;
 	return;
 }
 
@@ -269,6 +336,7 @@ void FileFilterIndex::setUIModeFilters()
 void FileFilterIndex::debugPrintIndexes()
 {
 	LOG(LogInfo) << "Printing Indexes...";
+	refreshIndexKeys();
 	for (auto x: playersIndexAllKeys) {
 		LOG(LogInfo) << "Multiplayer Index: " << x.first << ": " << x.second;
 	}
@@ -301,7 +369,7 @@ bool FileFilterIndex::showFile(FileData* game)
 	// if folder, needs further inspection - i.e. see if folder contains at least one element
 	// that should be shown
 	if (game->getType() == FOLDER) {
-		std::vector<FileData*> children = game->getChildren();
+		const std::vector<FileData*>& children = game->getChildren();
 		// iterate through all of the children, until there's a match
 
 		for (std::vector<FileData*>::const_iterator it = children.cbegin(); it != children.cend(); ++it ) {
@@ -313,61 +381,169 @@ bool FileFilterIndex::showFile(FileData* game)
 		return false;
 	}
 
-	bool keepGoing = false;
+	// indexed games are looked up in the precomputed result
+	auto idIt = mGameIds.find(game);
+	if (idIt != mGameIds.end())
+	{
+		if (idIt->second.metadataGeneration != game->metadata.getGeneration())
+			refreshPostings(game, idIt->second);
+
+		updateFilterResult();
 
+		const unsigned int id = idIt->second.id;
+		return (id / 64) < mFilterResult.size() && (mFilterResult[id / 64] & (1ULL << (id % 64)));
+	}
+
+	// games from other systems (i.e. the custom collections bundle) are evaluated one by one
 	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
-		FilterDataDecl filterData = (*it);
-		if(*(filterData.filteredByRef))
-		{
-			// try to find a match
-			std::string key = getIndexableKey(game, filterData.type, false);
-			keepGoing = isKeyBeingFilteredBy(key, filterData.type);
+		if (*((*it).filteredByRef) && !matchesFilter(game, *it))
+			return false;
+	}
 
-			// if we didn't find a match, try for secondary keys - i.e. publisher and dev, or first genre
-			if (!keepGoing)
-			{
-				if (!filterData.hasSecondaryKey)
-				{
-					return false;
-				}
-				std::string secKey = getIndexableKey(game, filterData.type, true);
-				if (secKey != UNKNOWN_LABEL)
-				{
-					keepGoing = isKeyBeingFilteredBy(secKey, filterData.type);
-				}
-			}
-			// if still nothing, then it's not a match
-			if (!keepGoing)
-				return false;
+	return true;
+}
 
-		}
+bool FileFilterIndex::matchesFilter(FileData* game, const FilterDataDecl& filterData)
+{
+	// try to find a match
+	if (isKeyBeingFilteredBy(getIndexableKey(game, filterData.type, false), filterData.type))
+		return true;
 
+	// if we didn't find a match, try for secondary keys - i.e. publisher and dev, or first genre
+	if (!filterData.hasSecondaryKey)
+		return false;
+
+	std::string secKey = getIndexableKey(game, filterData.type, true);
+	return (secKey != UNKNOWN_LABEL) && isKeyBeingFilteredBy(secKey, filterData.type);
+}
+
+bool FileFilterIndex::isKeyBeingFilteredBy(const std::string& key, FilterIndexType type)
+{
+	const FilterDataDecl* filterData = getFilterDataDecl(type);
+	if (!filterData)
+		return false;
+
+	const std::vector<std::string>& filteredKeys = *(filterData->currentFilteredKeys);
+	return std::find(filteredKeys.cbegin(), filteredKeys.cend(), key) != filteredKeys.cend();
+}
+
+const FilterDataDecl* FileFilterIndex::getFilterDataDecl(FilterIndexType type) const
+{
+	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
+		if ((*it).type == type)
+			return &(*it);
 	}
 
-	return keepGoing;
+	return nullptr;
 }
 
-bool FileFilterIndex::isKeyBeingFilteredBy(std::string key, FilterIndexType type)
+void FileFilterIndex::addToPostings(FileData* game, unsigned int id, FilterIndexType type)
 {
-	const FilterIndexType filterTypes[7] = { FAVORITES_FILTER, GENRE_FILTER, PLAYER_FILTER, PUBDEV_FILTER, RATINGS_FILTER,HIDDEN_FILTER, KIDGAME_FILTER };
-	std::vector<std::string> filterKeysList[7] = { favoritesIndexFilteredKeys, genreIndexFilteredKeys, playersIndexFilteredKeys, pubDevIndexFilteredKeys, ratingsIndexFilteredKeys, hiddenIndexFilteredKeys, kidGameIndexFilteredKeys };
+	const FilterDataDecl* filterData = getFilterDataDecl(type);
+	if (!filterData)
+		return;
 
-	for (int i = 0; i < 7; i++)
+	const size_t             word = id / 64;
+	const unsigned long long bit  = 1ULL << (id % 64);
+
+	// a game is listed under its primary key and, like showFile, under its secondary key when it has one
+	std::string keys[2] = { getIndexableKey(game, type, false), std::string() };
+	if (filterData->hasSecondaryKey)
 	{
-		if (filterTypes[i] == type)
+		keys[1] = getIndexableKey(game, type, true);
+		if (keys[1] == UNKNOWN_LABEL || keys[1] == keys[0])
+			keys[1].clear();
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (keys[i].empty())
+			continue;
+
+		Bitset& posting = mPostings[type][keys[i]];
+		if (posting.size() <= word)
+			posting.resize(word + 1, 0);
+
+		posting[word] |= bit;
+	}
+}
+
+void FileFilterIndex::removeFromPostings(unsigned int id)
+{
+	// the metadata may have changed since the game was added, so clear its bit from every posting
+	const size_t             word = id / 64;
+	const unsigned long long bit  = 1ULL << (id % 64);
+
+	for (int type = 0; type < FILTER_TYPE_COUNT; type++)
+	{
+		for (auto& posting : mPostings[type])
 		{
-			for (std::vector<std::string>::const_iterator it = filterKeysList[i].cbegin(); it != filterKeysList[i].cend(); ++it )
-			{
-				if (key == (*it))
-				{
-					return true;
-				}
-			}
-			return false;
+			if (word < posting.second.size())
+				posting.second[word] &= ~bit;
+		}
+	}
+}
+
+void FileFilterIndex::refreshPostings(FileData* game, IndexedGame& entry)
+{
+	// metadata was changed without going through removeFromIndex/addToIndex (i.e. scraping)
+	removeFromPostings(entry.id);
+
+	for (int type = 0; type < FILTER_TYPE_COUNT; type++)
+	{
+		if (mPostingsBuilt[type])
+			addToPostings(game, entry.id, (FilterIndexType)type);
+	}
+
+	entry.metadataGeneration = game->metadata.getGeneration();
+	mGeneration++;
+}
+
+void FileFilterIndex::buildPostings(FilterIndexType type)
+{
+	mPostings[type].clear();
+
+	for (auto it = mGameIds.cbegin(); it != mGameIds.cend(); ++it)
+		addToPostings(it->first, it->second.id, type);
+
+	mPostingsBuilt[type] = true;
+}
+
+void FileFilterIndex::updateFilterResult()
+{
+	if (mFilterResultGeneration == mGeneration)
+		return;
+
+	const size_t words = (mGameIdCount + 63) / 64;
+	mFilterResult.assign(words, ~0ULL);
+
+	// games have to match every active filter type, and any of the keys filtered for within a type
+	Bitset matches;
+	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it ) {
+		const FilterDataDecl& filterData = (*it);
+		if (!*(filterData.filteredByRef))
+			continue;
+
+		if (!mPostingsBuilt[filterData.type])
+			buildPostings(filterData.type);
+
+		matches.assign(words, 0);
+
+		for (auto keyIt = filterData.currentFilteredKeys->cbegin(); keyIt != filterData.currentFilteredKeys->cend(); ++keyIt) {
+			auto posting = mPostings[filterData.type].find(*keyIt);
+			if (posting == mPostings[filterData.type].cend())
+				continue;
+
+			const size_t count = std::min(words, posting->second.size());
+			for (size_t word = 0; word < count; word++)
+				matches[word] |= posting->second[word];
 		}
+
+		for (size_t word = 0; word < words; word++)
+			mFilterResult[word] &= matches[word];
 	}
 
-	return false;
+	mFilterResultGeneration = mGeneration;
 }
 
 void FileFilterIndex::manageGenreEntryInIndex(FileData* game, bool remove)
@@ -534,7 +710,43 @@ void FileFilterIndex::manageIndexEntry(std::map<std::string, int>* index, std::s
 	}
 }
 
-void FileFilterIndex::clearIndex(std::map<std::string, int> indexMap)
+void FileFilterIndex::refreshIndexKeys()
+{
+	if (!mIndexKeysStale)
+		return;
+
+	mIndexKeysStale = false;
+
+	clearIndex(genreIndexAllKeys);
+	clearIndex(playersIndexAllKeys);
+	clearIndex(pubDevIndexAllKeys);
+	clearIndex(ratingsIndexAllKeys);
+	clearIndex(favoritesIndexAllKeys);
+	clearIndex(hiddenIndexAllKeys);
+	clearIndex(kidGameIndexAllKeys);
+
+	for (auto& it : mGameIds)
+	{
+		it.second.keysGeneration = it.first->metadata.getGeneration();
+
+		manageGenreEntryInIndex(it.first);
+		managePlayerEntryInIndex(it.first);
+		managePubDevEntryInIndex(it.first);
+		manageRatingsEntryInIndex(it.first);
+		manageFavoritesEntryInIndex(it.first);
+		manageHiddenEntryInIndex(it.first);
+		manageKidGameEntryInIndex(it.first);
+	}
+
+	// counts merged from other indexes are taken again too
+	std::vector<FileFilterIndex*> importedIndexes;
+	importedIndexes.swap(mImportedIndexes);
+
+	for (auto index : importedIndexes)
+		importIndex(index);
+}
+
+void FileFilterIndex::clearIndex(std::map<std::string, int>& indexMap)
 {
 	indexMap.clear();
 }
@@ -3,6 +3,7 @@
 #define ES_APP_FILE_FILTER_INDEX_H
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -17,7 +18,8 @@ enum FilterIndexType
 	RATINGS_FILTER,
 	FAVORITES_FILTER,
 	HIDDEN_FILTER,
-	KIDGAME_FILTER
+	KIDGAME_FILTER,
+	FILTER_TYPE_COUNT
 };
 
 struct FilterDataDecl
@@ -44,7 +46,8 @@ public:
 	void debugPrintIndexes();
 	bool showFile(FileData* game);
 	bool isFiltered() { return (filterByGenre || filterByPlayers || filterByPubDev || filterByRatings || filterByFavorites || filterByHidden || filterByKidGame); };
-	bool isKeyBeingFilteredBy(std::string key, FilterIndexType type);
+	bool isKeyBeingFilteredBy(const std::string& key, FilterIndexType type);
+	inline unsigned int getGeneration() const { return mGeneration; } // changes with the filters and the indexed games
 	std::vector<FilterDataDecl>& getFilterDataDecls();
 
 	void importIndex(FileFilterIndex* indexToImport);
@@ -53,9 +56,28 @@ public:
 	void setUIModeFilters();
 
 private:
+	// one bit per indexed game, games get a dense id when added to the index
+	typedef std::vector<unsigned long long> Bitset;
+
+	struct IndexedGame
+	{
+		unsigned int id;
+		unsigned int metadataGeneration; // metadata the postings were built from
+		unsigned int keysGeneration;     // metadata the key counts were taken from
+	};
+
 	std::vector<FilterDataDecl> filterDataDecl;
 	std::string getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary);
 
+	const FilterDataDecl* getFilterDataDecl(FilterIndexType type) const;
+	bool matchesFilter(FileData* game, const FilterDataDecl& filterData);
+	void addToPostings(FileData* game, unsigned int id, FilterIndexType type);
+	void removeFromPostings(unsigned int id);
+	void refreshPostings(FileData* game, IndexedGame& entry);
+	void buildPostings(FilterIndexType type);
+	void updateFilterResult();
+	void refreshIndexKeys();
+
 	void manageGenreEntryInIndex(FileData* game, bool remove = false);
 	void managePlayerEntryInIndex(FileData* game, bool remove = false);
 	void managePubDevEntryInIndex(FileData* game, bool remove = false);
@@ -66,7 +88,7 @@ private:
 
 	void manageIndexEntry(std::map<std::string, int>* index, std::string key, bool remove);
 
-	void clearIndex(std::map<std::string, int> indexMap);
+	void clearIndex(std::map<std::string, int>& indexMap);
 
 	bool filterByGenre;
 	bool filterByPlayers;
@@ -84,6 +106,11 @@ private:
 	std::map<std::string, int> hiddenIndexAllKeys;
 	std::map<std::string, int> kidGameIndexAllKeys;
 
+	// the key counts can't be updated when a game's metadata changed before it was removed (collection entries
+	// share it with their source game), they are counted again from the indexed games the next time they are needed
+	bool mIndexKeysStale;
+	std::vector<FileFilterIndex*> mImportedIndexes;
+
 	std::vector<std::string> genreIndexFilteredKeys;
 	std::vector<std::string> playersIndexFilteredKeys;
 	std::vector<std::string> pubDevIndexFilteredKeys;
@@ -94,6 +121,19 @@ private:
 
 	FileData* mRootFolder;
 
+	// posting bitsets, built for a filter type the first time it is used, then kept up to date
+	std::map<std::string, Bitset> mPostings[FILTER_TYPE_COUNT];
+	bool mPostingsBuilt[FILTER_TYPE_COUNT];
+
+	std::unordered_map<FileData*, IndexedGame> mGameIds;
+	std::vector<unsigned int> mFreeGameIds;
+	unsigned int mGameIdCount;
+
+	// games passing all active filters, recomputed when the filters or the indexed games change
+	Bitset mFilterResult;
+	unsigned int mGeneration;
+	unsigned int mFilterResultGeneration;
+
 };
 
 #endif // ES_APP_FILE_FILTER_INDEX_H
@@ -3,6 +3,8 @@
 #include "utils/StringUtil.h"
 #include "Settings.h"
 #include "Log.h"
+#include <atomic>
+#include <mutex>
 
 namespace FileSorts
 {
@@ -41,27 +43,126 @@ namespace FileSorts
 
 	const std::vector<FileData::SortType> SortTypes(typesArr, typesArr + sizeof(typesArr)/sizeof(typesArr[0]));
 
-	//returns if file1 should come before file2
-	bool compareName(const FileData* file1, const FileData* file2)
+	static std::atomic<unsigned int> sortKeyGeneration(1);
+	static std::vector<std::string>  leadingArticles;
+	static std::once_flag            leadingArticlesLoaded;
+
+	static void loadLeadingArticles()
 	{
-		// we compare the actual metadata name, as collection files have the system appended which messes up the order
-		std::string name1 = Utils::String::toUpper(file1->metadata.get("sortname"));
-		std::string name2 = Utils::String::toUpper(file2->metadata.get("sortname"));
-		if(name1.empty()){
-			name1 = Utils::String::toUpper(file1->metadata.get("name"));
+		leadingArticles.clear();
+
+		if(Settings::getInstance()->getBool("IgnoreLeadingArticles"))
+		{
+			std::vector<std::string> articles = Utils::String::delimitedStringToVector(Settings::getInstance()->getString("LeadingArticles"), ",");
+
+			for(auto it = articles.cbegin(); it != articles.cend(); ++it)
+				leadingArticles.push_back(Utils::String::toUpper(*it) + " ");
 		}
-		if(name2.empty()){
-			name2 = Utils::String::toUpper(file2->metadata.get("name"));
+	}
+
+	void invalidateSortKeys()
+	{
+		// the articles are reloaded right away, make sure the lazy load in ignoreLeadingArticles can't run after that
+		std::call_once(leadingArticlesLoaded, [] { });
+		loadLeadingArticles();
+		sortKeyGeneration++;
+	}
+
+	unsigned int getSortKeyGeneration()
+	{
+		return sortKeyGeneration;
+	}
+
+	//If option is enabled, ignore leading articles by removing them from the sort key
+	//(Articles are defined within the settings config file)
+	static void ignoreLeadingArticles(std::string& name)
+	{
+		std::call_once(leadingArticlesLoaded, loadLeadingArticles);
+
+		for(auto it = leadingArticles.cbegin(); it != leadingArticles.cend(); ++it)
+		{
+			if(Utils::String::startsWith(name, *it))
+				name.erase(0, it->size());
 		}
+	}
+
+	static const std::string& getNameKey(const FileData* file)
+	{
+		FileData::SortKeys& keys = file->getSortKeys();
 
-		ignoreLeadingArticles(name1, name2);
+		if(!(keys.valid & FileData::SortKeys::NAME))
+		{
+			// we compare the actual metadata name, as collection files have the system appended which messes up the order
+			const std::string& sortName = file->metadata.get("sortname");
+			keys.name = Utils::String::toUpper(sortName.empty() ? file->metadata.get("name") : sortName);
+			ignoreLeadingArticles(keys.name);
+			keys.valid |= FileData::SortKeys::NAME;
+		}
 
-		return name1.compare(name2) < 0;
+		return keys.name;
+	}
+
+	static const std::string& getUpperKey(const FileData* file, const FileData::SortKeys::Field field)
+	{
+		FileData::SortKeys& keys = file->getSortKeys();
+
+		switch(field)
+		{
+			case FileData::SortKeys::GENRE:
+			{
+				if(!(keys.valid & field))
+					keys.genre = Utils::String::toUpper(file->metadata.get("genre"));
+				keys.valid |= field;
+				return keys.genre;
+			}
+			case FileData::SortKeys::DEVELOPER:
+			{
+				if(!(keys.valid & field))
+					keys.developer = Utils::String::toUpper(file->metadata.get("developer"));
+				keys.valid |= field;
+				return keys.developer;
+			}
+			case FileData::SortKeys::PUBLISHER:
+			{
+				if(!(keys.valid & field))
+					keys.publisher = Utils::String::toUpper(file->metadata.get("publisher"));
+				keys.valid |= field;
+				return keys.publisher;
+			}
+			default:
+			{
+				if(!(keys.valid & FileData::SortKeys::SYSTEM))
+					keys.system = Utils::String::toUpper(file->getSystemName());
+				keys.valid |= FileData::SortKeys::SYSTEM;
+				return keys.system;
+			}
+		}
+	}
+
+	static const FileData::SortKeys& getNumberKeys(const FileData* file)
+	{
+		FileData::SortKeys& keys = file->getSortKeys();
+
+		if(!(keys.valid & FileData::SortKeys::NUMBERS))
+		{
+			keys.rating    = file->metadata.getFloat("rating");
+			keys.players   = file->metadata.getInt("players");
+			keys.playCount = (file->metadata.getType() == GAME_METADATA) ? file->metadata.getInt("playcount") : 0;
+			keys.valid    |= FileData::SortKeys::NUMBERS;
+		}
+
+		return keys;
+	}
+
+	//returns if file1 should come before file2
+	bool compareName(const FileData* file1, const FileData* file2)
+	{
+		return getNameKey(file1).compare(getNameKey(file2)) < 0;
 	}
 
 	bool compareRating(const FileData* file1, const FileData* file2)
 	{
-		return file1->metadata.getFloat("rating") < file2->metadata.getFloat("rating");
+		return getNumberKeys(file1).rating < getNumberKeys(file2).rating;
 	}
 
 	bool compareTimesPlayed(const FileData* file1, const FileData* file2)
@@ -69,7 +170,7 @@ namespace FileSorts
 		//only games have playcount metadata
 		if(file1->metadata.getType() == GAME_METADATA && file2->metadata.getType() == GAME_METADATA)
 		{
-			return (file1)->metadata.getInt("playcount") < (file2)->metadata.getInt("playcount");
+			return getNumberKeys(file1).playCount < getNumberKeys(file2).playCount;
 		}
 
 		return false;
@@ -77,75 +178,37 @@ namespace FileSorts
 
 	bool compareLastPlayed(const FileData* file1, const FileData* file2)
 	{
-		// since it's stored as an ISO string (YYYYMMDDTHHMMSS), we can compare as a string
-		// as it's a lot faster than the time casts and then time comparisons
-		return (file1)->metadata.get("lastplayed") < (file2)->metadata.get("lastplayed");
+		return (file1)->metadata.getTime("lastplayed") < (file2)->metadata.getTime("lastplayed");
 	}
 
 	bool compareNumPlayers(const FileData* file1, const FileData* file2)
 	{
-		return (file1)->metadata.getInt("players") < (file2)->metadata.getInt("players");
+		return getNumberKeys(file1).players < getNumberKeys(file2).players;
 	}
 
 	bool compareReleaseDate(const FileData* file1, const FileData* file2)
 	{
-		// since it's stored as an ISO string (YYYYMMDDTHHMMSS), we can compare as a string
-		// as it's a lot faster than the time casts and then time comparisons
-		return (file1)->metadata.get("releasedate") < (file2)->metadata.get("releasedate");
+		return (file1)->metadata.getTime("releasedate") < (file2)->metadata.getTime("releasedate");
 	}
 
 	bool compareGenre(const FileData* file1, const FileData* file2)
 	{
-		std::string genre1 = Utils::String::toUpper(file1->metadata.get("genre"));
-		std::string genre2 = Utils::String::toUpper(file2->metadata.get("genre"));
-		return genre1.compare(genre2) < 0;
+		return getUpperKey(file1, FileData::SortKeys::GENRE).compare(getUpperKey(file2, FileData::SortKeys::GENRE)) < 0;
 	}
 
 	bool compareDeveloper(const FileData* file1, const FileData* file2)
 	{
-		std::string developer1 = Utils::String::toUpper(file1->metadata.get("developer"));
-		std::string developer2 = Utils::String::toUpper(file2->metadata.get("developer"));
-		return developer1.compare(developer2) < 0;
+		return getUpperKey(file1, FileData::SortKeys::DEVELOPER).compare(getUpperKey(file2, FileData::SortKeys::DEVELOPER)) < 0;
 	}
 
 	bool comparePublisher(const FileData* file1, const FileData* file2)
 	{
-		std::string publisher1 = Utils::String::toUpper(file1->metadata.get("publisher"));
-		std::string publisher2 = Utils::String::toUpper(file2->metadata.get("publisher"));
-		return publisher1.compare(publisher2) < 0;
+		return getUpperKey(file1, FileData::SortKeys::PUBLISHER).compare(getUpperKey(file2, FileData::SortKeys::PUBLISHER)) < 0;
 	}
 
 	bool compareSystem(const FileData* file1, const FileData* file2)
 	{
-		std::string system1 = Utils::String::toUpper(file1->getSystemName());
-		std::string system2 = Utils::String::toUpper(file2->getSystemName());
-		return system1.compare(system2) < 0;
-	}
-
-	//If option is enabled, ignore leading articles by temporarily modifying the name prior to sorting
-	//(Artciles are defined within the settings config file)
-	void ignoreLeadingArticles(std::string &name1, std::string &name2) {
-
-		if (Settings::getInstance()->getBool("IgnoreLeadingArticles"))
-		{
-
-			std::vector<std::string> articles = Utils::String::delimitedStringToVector(Settings::getInstance()->getString("LeadingArticles"), ",");
-
-			for(Utils::String::stringVector::iterator it = articles.begin(); it != articles.end(); it++)
-			{
-			
-				if (Utils::String::startsWith(Utils::String::toUpper(name1), Utils::String::toUpper(it[0]) + " ")) {
-					name1 = Utils::String::replace(Utils::String::toUpper(name1), Utils::String::toUpper(it[0]) + " ", "");
-				}
-
-				if (Utils::String::startsWith(Utils::String::toUpper(name2), Utils::String::toUpper(it[0]) + " ")) {
-					name2 = Utils::String::replace(Utils::String::toUpper(name2), Utils::String::toUpper(it[0]) + " ", "");
-				}
-
-			}
-
-		}
-
+		return getUpperKey(file1, FileData::SortKeys::SYSTEM).compare(getUpperKey(file2, FileData::SortKeys::SYSTEM)) < 0;
 	}
 
 };
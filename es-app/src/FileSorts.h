@@ -18,7 +18,9 @@ namespace FileSorts
 	bool comparePublisher(const FileData* file1, const FileData* file2);
 	bool compareSystem(const FileData* file1, const FileData* file2);
 
-	void ignoreLeadingArticles(std::string &name1, std::string &name2);
+	// sort keys are cached per FileData, this has to be called when a setting they depend on changes
+	void invalidateSortKeys();
+	unsigned int getSortKeyGeneration();
 
 	extern const std::vector<FileData::SortType> SortTypes;
 };
@@ -246,24 +246,23 @@ void updateGamelist(SystemData* system)
 	{
 		int numUpdated = 0;
 
-		std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
-
 		// Stage 1: iterate through all files in memory, checking for changes
-		for(std::vector<FileData*>::const_iterator fit = files.cbegin(); fit != files.cend(); ++fit)
+		FileData::FileIterator files(rootFolder, GAME | FOLDER);
+		while(FileData* file = files.next())
 		{
 
 			// do not touch if it wasn't changed anyway
-			if (!(*fit)->metadata.wasChanged())
+			if (!file->metadata.wasChanged())
 				continue;
 
 			// adding item to changed list
-			if ((*fit)->getType() == GAME)
+			if (file->getType() == GAME)
 			{
-				changedGames.push_back((*fit));
+				changedGames.push_back(file);
 			}
 			else
 			{
-				changedFolders.push_back((*fit));
+				changedFolders.push_back(file);
 			}
 		}
 
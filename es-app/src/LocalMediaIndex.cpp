@@ -0,0 +1,91 @@
+#include "LocalMediaIndex.h"
+
+#include "utils/FileSystemUtil.h"
+#include "Log.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#define S_ISDIR(x) (((x) & S_IFMT) == S_IFDIR)
+#endif // _WIN32
+
+struct MediaSuffix
+{
+	const char* suffix;
+	LocalMediaIndex::MediaType type;
+	bool preferred; // replaces a file found for the same name and type with another suffix
+};
+
+// .png first, same as the files used to be looked for
+static const MediaSuffix MEDIA_SUFFIXES[] =
+{
+	{ "-image.png",   LocalMediaIndex::IMAGE,   true },
+	{ "-image.jpg",   LocalMediaIndex::IMAGE,   false },
+	{ "-marquee.png", LocalMediaIndex::MARQUEE, true },
+	{ "-marquee.jpg", LocalMediaIndex::MARQUEE, false },
+	{ "-video.mp4",   LocalMediaIndex::VIDEO,   true },
+};
+
+std::string LocalMediaIndex::find(const std::string& startPath, const std::string& name, MediaType type)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	refresh(startPath);
+
+	auto it = mMedia.find(name);
+	return (it != mMedia.cend()) ? it->second.paths[type] : "";
+}
+
+void LocalMediaIndex::build(const std::string& startPath)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	refresh(startPath);
+}
+
+void LocalMediaIndex::refresh(const std::string& startPath)
+{
+	// adding, removing or renaming media changes the folder's mtime, it is looked at once a second at most
+	const time_t now = time(NULL);
+	if(mBuilt && now == mChecked)
+		return;
+
+	mChecked = now;
+
+	const std::string directory = startPath + "/images";
+	struct stat info;
+	const time_t modified = (!startPath.empty() && stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) ? info.st_mtime : 0;
+
+	if(mBuilt && modified == mModified)
+		return;
+
+	mBuilt = true;
+	mMedia.clear();
+
+	// changed during the second it is listed in, the mtime can't tell about another change in that second
+	mModified = (modified >= now) ? -1 : modified;
+
+	if(modified == 0)
+		return;
+
+	const Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(directory);
+	for(auto it = files.cbegin(); it != files.cend(); ++it)
+	{
+		const std::string fileName = Utils::FileSystem::getFileName(*it);
+
+		for(const MediaSuffix& media : MEDIA_SUFFIXES)
+		{
+			const size_t length = strlen(media.suffix);
+			if(fileName.size() <= length || fileName.compare(fileName.size() - length, length, media.suffix) != 0)
+				continue;
+
+			std::string& path = mMedia[fileName.substr(0, fileName.size() - length)].paths[media.type];
+			if(path.empty() || media.preferred)
+				path = directory + "/" + fileName;
+			break;
+		}
+	}
+
+	LOG(LogDebug) << "LocalMediaIndex: " << mMedia.size() << " games with media in " << directory;
+}
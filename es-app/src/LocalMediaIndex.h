@@ -0,0 +1,46 @@
+#pragma once
+#ifndef ES_APP_LOCAL_MEDIA_INDEX_H
+#define ES_APP_LOCAL_MEDIA_INDEX_H
+
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+
+// Media kept next to a system's roms, "[start path]/images/[name]-image.png", "-marquee.png" (or .jpg) and "-video.mp4".
+// The folder is listed on the first lookup, instead of checking every possible file on every lookup, and listed
+// again when its mtime changed. Can be used from any thread.
+class LocalMediaIndex
+{
+public:
+	enum MediaType
+	{
+		IMAGE,
+		MARQUEE,
+		VIDEO,
+
+		MEDIA_TYPE_COUNT
+	};
+
+	LocalMediaIndex() : mBuilt(false), mModified(0), mChecked(0) {}
+
+	// path of the game's media, empty when there is none
+	std::string find(const std::string& startPath, const std::string& name, MediaType type);
+	void build(const std::string& startPath);
+
+private:
+	struct Media
+	{
+		std::string paths[MEDIA_TYPE_COUNT];
+	};
+
+	void refresh(const std::string& startPath); // with mMutex locked
+
+	std::mutex mMutex;
+	bool mBuilt;
+	time_t mModified; // the folder's mtime when it was listed
+	time_t mChecked;  // last time it was compared
+	std::unordered_map<std::string, Media> mMedia; // by name
+};
+
+#endif // ES_APP_LOCAL_MEDIA_INDEX_H
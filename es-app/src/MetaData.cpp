@@ -4,6 +4,9 @@
 #include "utils/TimeUtil.h"
 #include "Log.h"
 #include <pugixml.hpp>
+#include <atomic>
+
+static std::atomic<unsigned int> sGeneration(0);
 
 MetaDataDecl gameDecls[] = {
 	// key,         type,                   default,            statistic,  name in GuiMetaDataEd,  prompt in GuiMetaDataEd
@@ -51,6 +54,34 @@ MetaDataDecl folderDecls[] = {
 };
 const std::vector<MetaDataDecl> folderMDD(folderDecls, folderDecls + sizeof(folderDecls) / sizeof(folderDecls[0]));
 
+// same conversion as Utils::Time::DateTime, invalid and missing dates end up as NOT_A_DATE_TIME
+static time_t parseTime(const std::string& value)
+{
+	time_t time = Utils::Time::stringToTime(value);
+	if(time < 0)
+		time = Utils::Time::NOT_A_DATE_TIME;
+
+	return time;
+}
+
+// the defaults of an MDD's MD_DATE and MD_TIME values, parsed once rather than for every new MetaDataList
+static std::vector<time_t> parseDefaultTimes(const std::vector<MetaDataDecl>& mdd)
+{
+	std::vector<time_t> times;
+	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
+		times.push_back((iter->type == MD_DATE || iter->type == MD_TIME) ? parseTime(iter->defaultValue) : 0);
+
+	return times;
+}
+
+static const std::vector<time_t>& getDefaultTimesByType(MetaDataListType type)
+{
+	static const std::vector<time_t> gameTimes = parseDefaultTimes(gameMDD);
+	static const std::vector<time_t> folderTimes = parseDefaultTimes(folderMDD);
+
+	return (type == FOLDER_METADATA) ? folderTimes : gameTimes;
+}
+
 const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type)
 {
 	switch(type)
@@ -68,11 +99,19 @@ const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type)
 
 
 MetaDataList::MetaDataList(MetaDataListType type)
-	: mType(type), mWasChanged(false)
+	: mType(type), mGeneration(0), mWasChanged(false)
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
-	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
-		set(iter->key, iter->defaultValue);
+	const std::vector<time_t>& defaultTimes = getDefaultTimesByType(type);
+	for(size_t i = 0; i < mdd.size(); i++)
+	{
+		mMap[mdd[i].key] = mdd[i].defaultValue;
+		if(mdd[i].type == MD_DATE || mdd[i].type == MD_TIME)
+			mTimes[mdd[i].key] = defaultTimes[i];
+	}
+
+	mGeneration = ++sGeneration;
+	mWasChanged = true;
 }
 
 
@@ -93,10 +132,9 @@ MetaDataList MetaDataList::createFromXML(MetaDataListType type, pugi::xml_node&
 			{
 				value = Utils::FileSystem::resolveRelativePath(value, relativeTo, true, true);
 			}
-			mdl.set(iter->key, value);
-		}else{
-			mdl.set(iter->key, iter->defaultValue);
+			mdl.set(iter->key, value, iter->type);
 		}
+		// otherwise the default the list was made with is kept
 	}
 
 	return mdl;
@@ -127,8 +165,31 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 }
 
 void MetaDataList::set(const std::string& key, const std::string& value)
+{
+	MetaDataType type = MD_STRING;
+
+	const std::vector<MetaDataDecl>& mdd = getMDD();
+	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
+	{
+		if(iter->key == key)
+		{
+			type = iter->type;
+			break;
+		}
+	}
+
+	set(key, value, type);
+}
+
+void MetaDataList::set(const std::string& key, const std::string& value, MetaDataType type)
 {
 	mMap[key] = value;
+	mGeneration = ++sGeneration;
+
+	// dates are parsed here rather than on first read so getTime() stays read-only for the threads sharing this list
+	if(type == MD_DATE || type == MD_TIME)
+		mTimes[key] = parseTime(value);
+
 	mWasChanged = true;
 }
 
@@ -147,6 +208,20 @@ float MetaDataList::getFloat(const std::string& key) const
 	return (float)atof(get(key).c_str());
 }
 
+time_t MetaDataList::getTime(const std::string& key) const
+{
+	auto it = mTimes.find(key);
+	if(it != mTimes.cend())
+		return it->second;
+
+	return parseTime(get(key));
+}
+
+unsigned int MetaDataList::getLastGeneration()
+{
+	return sGeneration;
+}
+
 bool MetaDataList::wasChanged() const
 {
 	return mWasChanged;
@@ -5,6 +5,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <time.h>
 
 namespace pugi { class xml_node; }
 
@@ -55,6 +56,7 @@ public:
 	const std::string& get(const std::string& key) const;
 	int getInt(const std::string& key) const;
 	float getFloat(const std::string& key) const;
+	time_t getTime(const std::string& key) const; // MD_DATE and MD_TIME values, parsed when they are set
 
 	bool wasChanged() const;
 	void resetChangedFlag();
@@ -62,9 +64,17 @@ public:
 	inline MetaDataListType getType() const { return mType; }
 	inline const std::vector<MetaDataDecl>& getMDD() const { return getMDDByType(getType()); }
 
+	// unique stamp of the last change, copies share it so values derived from the metadata can be cached against it
+	inline unsigned int getGeneration() const { return mGeneration; }
+	static unsigned int getLastGeneration(); // stamp of the last change made to any MetaDataList
+
 private:
+	void set(const std::string& key, const std::string& value, MetaDataType type); // type is the key's, for callers walking the MDD anyway
+
 	MetaDataListType mType;
 	std::map<std::string, std::string> mMap;
+	std::map<std::string, time_t> mTimes;
+	unsigned int mGeneration;
 	bool mWasChanged;
 };
 
@@ -12,6 +12,7 @@
 #include "views/UIModeController.h"
 #include <fstream>
 #include <random>
+#include <unordered_set>
 #include "utils/StringUtil.h"
 #include "utils/ThreadPool.h"
 #include "Window.h"
@@ -537,7 +538,7 @@ bool SystemData::hasGamelist() const
 
 unsigned int SystemData::getGameCount() const
 {
-	return (unsigned int)mRootFolder->getFilesRecursive(GAME).size();
+	return mRootFolder->getGameCount();
 }
 
 SystemData* SystemData::getRandomSystem()
@@ -575,9 +576,76 @@ FileData* SystemData::getRandomGame()
 	return random_game;
 }
 
+std::vector<FileData*> SystemData::getRandomGames(unsigned int count, const std::function<bool(FileData*)>& accept)
+{
+	std::vector<FileData*> games;
+	const unsigned int total = mRootFolder->getGameCount();
+
+	if (count == 0 || total == 0)
+		return games;
+
+	if (!mFilterIndex->isFiltered())
+	{
+		// draw distinct positions and look them up through the cached game counts, without visiting the other games
+		std::unordered_set<unsigned int> drawn;
+		std::uniform_int_distribution<unsigned int> distribution(0, total - 1);
+		int retryCount = 10;
+
+		while (games.size() < count && drawn.size() < total && retryCount > 0)
+		{
+			const unsigned int position = distribution(sURNG);
+			if (!drawn.insert(position).second)
+				continue;
+
+			FileData* game = mRootFolder->getGameAt(position);
+			if (game && accept(game))
+			{
+				games.push_back(game);
+				retryCount = 10;
+			}
+			else
+			{
+				// either we are very unlucky, or most games can't be taken, give up after a few in a row
+				retryCount--;
+			}
+		}
+	}
+	else
+	{
+		// positions don't account for the filters, keep a reservoir of count games while visiting the displayed ones
+		unsigned int seen = 0;
+		mRootFolder->forEachFile(GAME, [&](FileData* game)
+		{
+			if (!accept(game))
+				return true;
+
+			if (games.size() < count)
+			{
+				games.push_back(game);
+			}
+			else
+			{
+				const unsigned int slot = std::uniform_int_distribution<unsigned int>(0, seen)(sURNG);
+				if (slot < count)
+					games[slot] = game;
+			}
+
+			seen++;
+			return true;
+		}, true);
+	}
+
+	return games;
+}
+
 unsigned int SystemData::getDisplayedGameCount() const
 {
-	return (unsigned int)mRootFolder->getFilesRecursive(GAME, true).size();
+	if(!mFilterIndex->isFiltered())
+		return mRootFolder->getGameCount();
+
+	unsigned int count = 0;
+	mRootFolder->forEachFile(GAME, [&count](FileData*) { count++; return true; }, true);
+	return count;
 }
 
 void SystemData::loadTheme()
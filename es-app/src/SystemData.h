@@ -2,8 +2,10 @@
 #ifndef ES_APP_SYSTEM_DATA_H
 #define ES_APP_SYSTEM_DATA_H
 
+#include "LocalMediaIndex.h"
 #include "PlatformId.h"
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <random>
 #include <string>
@@ -22,6 +24,7 @@ struct SystemEnvironmentData
 	std::vector<std::string> mSearchExtensions;
 	std::string mLaunchCommand;
 	std::vector<PlatformIds::PlatformId> mPlatformIds;
+	LocalMediaIndex mLocalMedia;
 };
 
 class SystemData
@@ -70,6 +73,8 @@ public:
 
 	static SystemData* getRandomSystem();
 	FileData* getRandomGame();
+	// up to count distinct displayed games, only the ones accept() returns true for are taken
+	std::vector<FileData*> getRandomGames(unsigned int count, const std::function<bool(FileData*)>& accept);
 
 	// Load or re-load theme.
 	void loadTheme();
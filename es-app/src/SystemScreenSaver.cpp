@@ -22,11 +22,10 @@
 #include <random>
 #include <time.h>
 #include <unordered_map>
+#include <unordered_set>
 
 #define FADE_TIME 			300
 
-static int lastIndex = 0;
-
 SystemScreenSaver::SystemScreenSaver(Window* window) :
 	mVideoScreensaver(NULL),
 	mImageScreensaver(NULL),
@@ -229,16 +228,13 @@ void SystemScreenSaver::startScreenSaver(SystemData* system)
 		mSwapTimeout = Settings::getInstance()->getInt("ScreenSaverSwapVideoTimeout");
 		mOpacity = 0.0f;
 
-		// Load a random video
+		// Load a random video, only games whose video is there are picked
 		std::string path = "";
 		pickRandomVideo(path, mCurrentGame != NULL);
 
-		int retry = 200;
-		while(retry > 0 && ((path.empty() || !Utils::FileSystem::exists(path)) || mCurrentGame == NULL))
-		{
-			retry--;
+		// the game kept from before may have no video, when the slideshow was shown last
+		if (path.empty() || !Utils::FileSystem::exists(path))
 			pickRandomVideo(path);
-		}
 
 		if (!path.empty() && Utils::FileSystem::exists(path))
 		{
@@ -388,26 +384,57 @@ void SystemScreenSaver::renderScreenSaver()
 	}
 }
 
+// each directory holding media is listed once into the exists() cache rather than every file being looked at on its own
+// a directory too large for the cache to keep its listing still has its files looked at one by one
+static bool mediaExists(const std::string& path, std::unordered_set<std::string>& listed)
+{
+	const std::string directory = Utils::FileSystem::getParent(path);
+	if (listed.insert(directory).second)
+		Utils::FileSystem::getDirContent(directory);
+
+	return Utils::FileSystem::exists(path);
+}
+
 void SystemScreenSaver::backgroundIndexing()
 {
 	LOG(LogDebug) << "Background indexing starting.";
 
-	// get the list of all games
-	SystemData* all = CollectionSystemManager::get()->getAllGamesCollection();
-	std::vector<FileData*> files = all->getRootFolder()->getFilesRecursive(GAME);
-
+	// list the local media of every system once, the games' media lookups then never touch the disk
+	// the image and video paths from the gamelists are put in the exists() cache for pickGameListNode()
+	int indexed = 0;
+	size_t paths = 0;
+	std::unordered_set<std::string> directories;
 	const auto startTs = std::chrono::system_clock::now();
-	for ( ; lastIndex < files.size(); lastIndex++)
+	for (auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); ++it)
 	{
 		if(mExit)
 			break;
-		Utils::FileSystem::exists(files.at(lastIndex)->getVideoPath());
-		Utils::FileSystem::exists(files.at(lastIndex)->getMarqueePath());
-		Utils::FileSystem::exists(files.at(lastIndex)->getThumbnailPath());
-		Utils::FileSystem::exists(files.at(lastIndex)->getImagePath());
+		if (!(*it)->isGameSystem() || (*it)->isCollection())
+			continue;
+
+		SystemEnvironmentData* envData = (*it)->getSystemEnvData();
+		envData->mLocalMedia.build(envData->mStartPath);
+		indexed++;
+
+		FileData::FileIterator files((*it)->getRootFolder(), GAME);
+		while (FileData* file = files.next())
+		{
+			if(mExit)
+				break;
+
+			const std::string media[] = { file->metadata.get("video"), file->metadata.get("image") };
+			for (const std::string& path : media)
+			{
+				if (path.empty())
+					continue;
+
+				mediaExists(path, directories);
+				paths++;
+			}
+		}
 	}
 	auto endTs = std::chrono::system_clock::now();
-	LOG(LogDebug) << "Indexed a total of " << lastIndex << " entries in " << std::chrono::duration_cast<std::chrono::milliseconds>(endTs - startTs).count() << " ms. Stopping.";
+	LOG(LogDebug) << "Indexed the media of " << indexed << " systems and " << paths << " gamelist media paths in " << directories.size() << " directories in " << std::chrono::duration_cast<std::chrono::milliseconds>(endTs - startTs).count() << " ms. Stopping.";
 }
 
 void SystemScreenSaver::getAllGamelistNodesForSystem(SystemData* system) {
@@ -432,41 +459,31 @@ void SystemScreenSaver::getAllGamelistNodes()
 
 void SystemScreenSaver::pickGameListNode(const char *nodeName)
 {
-	FileData *itf = nullptr;
-	bool found =  false;
-	int missCtr = 0;
-	while (!found)
+	// only the games whose media is really there are kept, each one is shown once before the list is made again
+	// local media comes from the systems' media indexes and the other paths from their directories' listings
+	if (mAllFiles.empty() || mAllFilesMedia != nodeName)
 	{
-		if (mAllFiles.empty())
-		{
-			if (mSystem)
-				getAllGamelistNodesForSystem(mSystem);
-			else
-				getAllGamelistNodes();
-
-			if (mAllFiles.empty()) { return; } // no games at all
-			mAllFilesSize = mAllFiles.size();
-			std::shuffle(std::begin(mAllFiles), std::end(mAllFiles), SystemData::sURNG);
-		}
-
-		itf = mAllFiles.back();
-		mAllFiles.pop_back();
-		if ((strcmp(nodeName, "video") == 0 && itf->getVideoPath() != "") ||
-			(strcmp(nodeName, "image") == 0 && itf->getImagePath() != ""))
-		{
-			found = true;
-		}
+		mAllFiles.clear();
+		if (mSystem)
+			getAllGamelistNodesForSystem(mSystem);
 		else
+			getAllGamelistNodes();
+
+		const bool video = (strcmp(nodeName, "video") == 0);
+		std::unordered_set<std::string> directories;
+		mAllFiles.erase(std::remove_if(mAllFiles.begin(), mAllFiles.end(), [video, &directories](FileData* file)
 		{
-			missCtr++;
-			if (missCtr == mAllFilesSize)
-				// avoid looping forever when no candidate exist
-				// with image/video path set
-				return;
-		}
+			const std::string path = video ? file->getVideoPath() : file->getImagePath();
+			return path.empty() || !mediaExists(path, directories);
+		}), mAllFiles.end());
+		mAllFilesMedia = nodeName;
+
+		if (mAllFiles.empty()) { return; } // no game with image/video path set
+		std::shuffle(std::begin(mAllFiles), std::end(mAllFiles), SystemData::sURNG);
 	}
 
-	mCurrentGame = itf;
+	mCurrentGame = mAllFiles.back();
+	mAllFiles.pop_back();
 }
 
 void SystemScreenSaver::prepareScreenSaverMedia(const char *nodeName, std::string& path)
@@ -67,7 +67,7 @@ private:
 	bool			mStopBackgroundAudio;
 	std::vector<FileData*>	mAllFiles;
 	std::vector<std::string> mCustomMediaFiles;
-	int			mAllFilesSize;
+	std::string		mAllFilesMedia; // "video" or "image", what mAllFiles was made for
 	std::thread*		mThread;
 	bool			mExit;
 	std::string 		mRegularEditingCollection;
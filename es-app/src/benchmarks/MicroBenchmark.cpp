@@ -0,0 +1,468 @@
+// Microbenchmarks for the functions hit per frame and per load. Every benchmark runs on deterministic
+// data, is warmed up once and then timed several times, the median is reported so numbers can be
+// compared across commits. Each benchmark is reported as one JSON object per line on stdout.
+
+#include "renderers/Renderer.h"
+#include "resources/Font.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "FileData.h"
+#include "FileFilterIndex.h"
+#include "FileSorts.h"
+#include "ImageIO.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <FreeImage.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+
+struct MicroBenchmark
+{
+	std::string           name;
+	unsigned int          opsPerRun;
+	std::function<void()> run;
+};
+
+struct MicroBenchmarkParams
+{
+	int         repeat  = 9;
+	int         entries = 50000;
+	bool        font    = true;
+	std::string filter;
+};
+
+// results are accumulated here so the compiler can't discard the work being measured
+static volatile size_t sink = 0;
+
+static const char* GENRES[]   = { "Action", "Platform", "Shooter", "Puzzle", "Racing", "Sports", "Role Playing Game", "Action/Adventure", "Fighting", "Strategy" };
+static const char* ARTICLES[] = { "", "", "", "The ", "A ", "An " };
+
+static std::string getGameName(std::mt19937& rng, const int game)
+{
+	static const char* words[] = { "super", "Mega", "Dragon", "quest", "Legend", "of", "Star", "Fighter", "Racer", "Kart", "Island", "Zone", "Bros.", "World", "Turbo" };
+	static const char* regions[] = { "", " (USA)", " (Europe)", " (Japan) [!]", " (USA, Europe) (Rev 1)" };
+
+	std::string name = ARTICLES[rng() % (sizeof(ARTICLES) / sizeof(ARTICLES[0]))];
+	const int wordCount = 1 + (rng() % 4);
+
+	for(int word = 0; word < wordCount; word++)
+		name += std::string(word ? " " : "") + words[rng() % (sizeof(words) / sizeof(words[0]))];
+
+	return name + " " + std::to_string(game % 100) + regions[rng() % (sizeof(regions) / sizeof(regions[0]))];
+}
+
+static std::vector<FileData*> createGames(SystemData* system, const int count)
+{
+	std::mt19937           rng(1234);
+	std::vector<FileData*> games;
+	games.reserve(count);
+
+	for(int game = 0; game < count; game++)
+	{
+		FileData* file = new FileData(GAME, "/benchmark/roms/game" + std::to_string(game) + ".zip", system->getSystemEnvData(), system);
+		file->metadata.set("name",        getGameName(rng, game));
+		file->metadata.set("rating",      std::to_string((rng() % 11) / 10.0f));
+		file->metadata.set("releasedate", std::to_string(1980 + (rng() % 40)) + "0" + std::to_string(1 + (rng() % 9)) + "15T000000");
+		file->metadata.set("developer",   "Developer " + std::to_string(rng() % 97));
+		file->metadata.set("publisher",   "Publisher " + std::to_string(rng() % 53));
+		file->metadata.set("genre",       GENRES[rng() % (sizeof(GENRES) / sizeof(GENRES[0]))]);
+		file->metadata.set("players",     std::to_string(1 + (rng() % 4)));
+		file->metadata.set("favorite",    (rng() % 10) == 0 ? "true" : "false");
+		file->metadata.set("playcount",   std::to_string(rng() % 20));
+		file->metadata.set("lastplayed",  (rng() % 3) == 0 ? "20" + std::to_string(10 + (rng() % 10)) + "0101T120000" : "");
+		games.push_back(file);
+	}
+
+	return games;
+}
+
+static std::vector<unsigned char> createPNG(const int width, const int height)
+{
+	std::vector<unsigned char> pixels(width * height * 4);
+	std::vector<unsigned char> encoded;
+
+	for(int y = 0; y < height; y++)
+	{
+		for(int x = 0; x < width; x++)
+		{
+			unsigned char* pixel = &pixels[(y * width + x) * 4];
+			pixel[0] = (unsigned char)(x ^ y);
+			pixel[1] = (unsigned char)(x * 3);
+			pixel[2] = (unsigned char)(y * 5);
+			pixel[3] = (unsigned char)(255 - ((x + y) & 0x3F));
+		}
+	}
+
+	FIBITMAP* bitmap = FreeImage_ConvertFromRawBits(pixels.data(), width, height, width * 4, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true);
+	FIMEMORY* memory = FreeImage_OpenMemory();
+
+	if(bitmap && FreeImage_SaveToMemory(FIF_PNG, bitmap, memory))
+	{
+		BYTE* data = nullptr;
+		DWORD size = 0;
+
+		if(FreeImage_AcquireMemory(memory, &data, &size))
+			encoded.assign(data, data + size);
+	}
+
+	FreeImage_CloseMemory(memory);
+
+	if(bitmap)
+		FreeImage_Unload(bitmap);
+
+	return encoded;
+}
+
+static void addSortBenchmarks(std::vector<MicroBenchmark>& benchmarks, const std::vector<FileData*>& games)
+{
+	for(auto& sortType : FileSorts::SortTypes)
+	{
+		// descending variants use the same comparator
+		if(!sortType.ascending)
+			continue;
+
+		FileData::ComparisonFunction* comparator = sortType.comparisonFunction;
+		const std::string             name       = sortType.description.substr(0, sortType.description.find(','));
+
+		benchmarks.push_back({ "FileSorts/" + name, 1, [&games, comparator]
+		{
+			std::vector<FileData*> sorted = games;
+			std::stable_sort(sorted.begin(), sorted.end(), comparator);
+			sink += (size_t)sorted.front();
+		}});
+	}
+}
+
+static void addFilterBenchmarks(std::vector<MicroBenchmark>& benchmarks, const std::vector<FileData*>& games, FileFilterIndex* index)
+{
+	struct FilterCase
+	{
+		std::string                                               name;
+		std::vector<std::pair<FilterIndexType, std::vector<std::string>>> filters;
+	};
+
+	static const std::vector<FilterCase> cases =
+	{
+		{ "none",              { } },
+		{ "genre",             { { GENRE_FILTER,     { "ACTION", "PLATFORM" } } } },
+		{ "genre+players",     { { GENRE_FILTER,     { "ACTION", "PLATFORM", "SHOOTER" } }, { PLAYER_FILTER, { "2", "4" } } } },
+		{ "pubdev",            { { PUBDEV_FILTER,    { "PUBLISHER 1", "PUBLISHER 2", "DEVELOPER 3" } } } },
+		{ "favorites+ratings", { { FAVORITES_FILTER, { "TRUE" } }, { RATINGS_FILTER, { "3 STARS", "4 STARS", "5 STARS" } } } },
+	};
+
+	for(auto& filterCase : cases)
+	{
+		const FilterCase* current = &filterCase;
+
+		benchmarks.push_back({ "FileFilterIndex::showFile/" + filterCase.name, (unsigned int)games.size(), [&games, index, current]
+		{
+			index->clearAllFilters();
+
+			for(auto& filter : current->filters)
+			{
+				std::vector<std::string> values = filter.second;
+				index->setFilter(filter.first, &values);
+			}
+
+			size_t shown = 0;
+			for(auto game : games)
+				shown += index->showFile(game);
+
+			sink += shown;
+		}});
+	}
+}
+
+static void addMetaDataBenchmarks(std::vector<MicroBenchmark>& benchmarks, const std::vector<FileData*>& games)
+{
+	static const char* keys[] = { "name", "genre", "releasedate", "players", "rating", "lastplayed" };
+
+	benchmarks.push_back({ "MetaDataList::get", (unsigned int)(games.size() * 6), [&games]
+	{
+		size_t length = 0;
+		for(auto game : games)
+		{
+			for(auto key : keys)
+				length += game->metadata.get(key).size();
+		}
+		sink += length;
+	}});
+
+	benchmarks.push_back({ "MetaDataList::getInt", (unsigned int)games.size(), [&games]
+	{
+		int total = 0;
+		for(auto game : games)
+			total += game->metadata.getInt("playcount");
+		sink += total;
+	}});
+
+	benchmarks.push_back({ "MetaDataList::set", (unsigned int)games.size(), [&games]
+	{
+		for(auto game : games)
+			game->metadata.set("playcount", game->metadata.get("players"));
+	}});
+}
+
+static void addStringBenchmarks(std::vector<MicroBenchmark>& benchmarks, const std::vector<FileData*>& games)
+{
+	benchmarks.push_back({ "Utils::String::toUpper", (unsigned int)games.size(), [&games]
+	{
+		size_t length = 0;
+		for(auto game : games)
+			length += Utils::String::toUpper(game->metadata.get("name")).size();
+		sink += length;
+	}});
+
+	benchmarks.push_back({ "Utils::String::removeParenthesis", (unsigned int)games.size(), [&games]
+	{
+		size_t length = 0;
+		for(auto game : games)
+			length += Utils::String::removeParenthesis(game->metadata.get("name")).size();
+		sink += length;
+	}});
+}
+
+static void addFileSystemBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+	// these paths exist on every system so the canonical path resolution walks real directories
+	static const std::vector<std::string> paths =
+	{
+		Utils::FileSystem::getHomePath(),
+		Utils::FileSystem::getHomePath() + "/./configs/../configs/emulationstation/es_settings.cfg",
+		Utils::FileSystem::getExePath() + "/../" + Utils::FileSystem::getFileName(Utils::FileSystem::getExePath()),
+		Utils::FileSystem::getCWDPath() + "/.",
+	};
+
+	static const std::vector<std::string> relativePaths =
+	{
+		"./media/images/game1.png",
+		"~/configs/emulationstation/gamelists/snes/gamelist.xml",
+		"/usr/share/emulationstation/themes",
+		"../roms/snes/Super Mario World (USA).zip",
+	};
+
+	benchmarks.push_back({ "Utils::FileSystem::getCanonicalPath", (unsigned int)paths.size() * 100, []
+	{
+		size_t length = 0;
+		for(int i = 0; i < 100; i++)
+		{
+			for(auto& path : paths)
+				length += Utils::FileSystem::getCanonicalPath(path).size();
+		}
+		sink += length;
+	}});
+
+	benchmarks.push_back({ "Utils::FileSystem::resolveRelativePath", (unsigned int)relativePaths.size() * 1000, []
+	{
+		size_t length = 0;
+		for(int i = 0; i < 1000; i++)
+		{
+			for(auto& path : relativePaths)
+				length += Utils::FileSystem::resolveRelativePath(path, "/home/pi/RetroPie/roms/snes", true, true).size();
+		}
+		sink += length;
+	}});
+}
+
+static void addImageBenchmarks(std::vector<MicroBenchmark>& benchmarks, const std::vector<unsigned char>& png)
+{
+	if(png.empty())
+	{
+		LOG(LogWarning) << "MicroBenchmark: could not encode the test image, skipping ImageIO";
+		return;
+	}
+
+	benchmarks.push_back({ "ImageIO::loadFromMemoryRGBA32/512x512", 1, [&png]
+	{
+		size_t width  = 0;
+		size_t height = 0;
+		sink += ImageIO::loadFromMemoryRGBA32(png.data(), png.size(), width, height).size();
+	}});
+}
+
+static void addFontBenchmarks(std::vector<MicroBenchmark>& benchmarks, const std::vector<FileData*>& games, std::shared_ptr<Font>& font)
+{
+	static std::string description;
+
+	for(size_t game = 0; game < 20; game++)
+		description += games[game]->metadata.get("name") + " is a " + games[game]->metadata.get("genre") + " game. ";
+
+	const int count = (int)std::min(games.size(), (size_t)1000);
+
+	benchmarks.push_back({ "Font::sizeText", (unsigned int)count, [&games, &font, count]
+	{
+		float width = 0;
+		for(int game = 0; game < count; game++)
+			width += font->sizeText(games[game]->metadata.get("name")).x();
+		sink += (size_t)width;
+	}});
+
+	benchmarks.push_back({ "Font::wrapText", 1, [&font]
+	{
+		sink += font->wrapText(description, 400.0f).size();
+	}});
+
+	benchmarks.push_back({ "Font::buildTextCache", (unsigned int)count, [&games, &font, count]
+	{
+		for(int game = 0; game < count; game++)
+		{
+			TextCache* cache = font->buildTextCache(games[game]->metadata.get("name"), 0, 0, 0xFFFFFFFF);
+			sink += (size_t)cache;
+			delete cache;
+		}
+	}});
+
+	benchmarks.push_back({ "Font::buildTextCache/wrapped", 1, [&font]
+	{
+		TextCache* cache = font->buildTextCache(description, Vector2f(0, 0), 0xFFFFFFFF, 400.0f, ALIGN_LEFT);
+		sink += (size_t)cache;
+		delete cache;
+	}});
+}
+
+static void runBenchmark(const MicroBenchmark& benchmark, const MicroBenchmarkParams& params)
+{
+	std::vector<double> times;
+
+	// warm up caches, glyph atlases and lazily initialized statics first
+	benchmark.run();
+
+	for(int run = 0; run < params.repeat; run++)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		benchmark.run();
+		times.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	std::sort(times.begin(), times.end());
+
+	const double median = times[times.size() / 2];
+
+	std::cout << "{\"benchmark\":\"" << benchmark.name << "\"" <<
+		",\"entries\":" << params.entries <<
+		",\"ops_per_run\":" << benchmark.opsPerRun <<
+		",\"runs\":" << params.repeat <<
+		",\"median_ns_per_op\":" << (median / benchmark.opsPerRun) <<
+		",\"min_ns_per_op\":" << (times.front() / benchmark.opsPerRun) <<
+		",\"max_ns_per_op\":" << (times.back() / benchmark.opsPerRun) << "}" << std::endl;
+}
+
+static bool parseArgs(int argc, char* argv[], MicroBenchmarkParams& params)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--no-font") == 0)
+		{
+			params.font = false;
+			continue;
+		}
+
+		if(i >= argc - 1)
+		{
+			std::cerr << "Missing value for " << argv[i] << "\n";
+			return false;
+		}
+
+		const char* value = argv[++i];
+
+		if(strcmp(argv[i - 1], "--repeat") == 0)       params.repeat  = std::max(1, atoi(value));
+		else if(strcmp(argv[i - 1], "--entries") == 0) params.entries = std::max(20, atoi(value));
+		else if(strcmp(argv[i - 1], "--filter") == 0)  params.filter  = value;
+		else
+		{
+			std::cerr << "Unknown option " << argv[i - 1] << "\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	MicroBenchmarkParams params;
+
+	if(!parseArgs(argc, argv, params))
+	{
+		std::cerr << "usage: es-micro-benchmark [--repeat N] [--entries N] [--filter SUBSTRING] [--no-font]\n";
+		return 1;
+	}
+
+	Utils::FileSystem::setExePath(argv[0]);
+
+#ifdef FREEIMAGE_LIB
+	FreeImage_Initialise();
+#endif
+
+	Log::init();
+	Log::open();
+
+	// settings that change what the measured code does are pinned so runs stay comparable
+	Settings::getInstance()->setString("SaveGamelistsMode", "never");
+	Settings::getInstance()->setBool("IgnoreLeadingArticles", true);
+	Settings::getInstance()->setString("LeadingArticles", "a,an,the");
+
+	SystemEnvironmentData* envData = new SystemEnvironmentData;
+	SystemData*            system  = new SystemData("benchmark", "Benchmark", envData, "", true);
+	std::vector<FileData*> games   = createGames(system, params.entries);
+
+	for(auto game : games)
+		system->getIndex()->addToIndex(game);
+
+	const std::vector<unsigned char> png = createPNG(512, 512);
+
+	std::vector<MicroBenchmark> benchmarks;
+	addSortBenchmarks(benchmarks, games);
+	addFilterBenchmarks(benchmarks, games, system->getIndex());
+	addMetaDataBenchmarks(benchmarks, games);
+	addStringBenchmarks(benchmarks, games);
+	addFileSystemBenchmarks(benchmarks);
+	addImageBenchmarks(benchmarks, png);
+
+	// fonts need a renderer for their glyph textures, use the null renderer to run these headless
+	std::shared_ptr<Font> font;
+
+	if(params.font)
+	{
+		if(Renderer::init())
+		{
+			font = Font::get(FONT_SIZE_MEDIUM);
+			addFontBenchmarks(benchmarks, games, font);
+		}
+		else
+		{
+			LOG(LogWarning) << "MicroBenchmark: renderer failed to initialize, skipping Font";
+			params.font = false;
+		}
+	}
+
+	for(auto& benchmark : benchmarks)
+	{
+		if(params.filter.empty() || benchmark.name.find(params.filter) != std::string::npos)
+			runBenchmark(benchmark, params);
+	}
+
+	if(params.font)
+	{
+		font.reset();
+		Renderer::deinit();
+	}
+
+	system->getIndex()->resetIndex();
+
+	for(auto game : games)
+		delete game;
+
+	delete system;
+	delete envData;
+
+	Log::close();
+
+	return 0;
+}
@@ -0,0 +1,357 @@
+#include "benchmarks/MockScraperServer.h"
+
+#include <FreeImage.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+// how often the blocking loops look at mRunning
+static const int POLL_TIMEOUT_MS = 100;
+
+static std::string urlDecode(const std::string& _string)
+{
+	std::string decoded;
+
+	for(size_t i = 0; i < _string.size(); i++)
+	{
+		if(_string[i] == '%' && i + 2 < _string.size())
+		{
+			decoded += (char)strtol(_string.substr(i + 1, 2).c_str(), nullptr, 16);
+			i += 2;
+		}
+		else
+		{
+			decoded += (_string[i] == '+') ? ' ' : _string[i];
+		}
+	}
+
+	return decoded;
+}
+
+static std::string getQueryParameter(const std::string& target, const std::string& name)
+{
+	const size_t query = target.find('?');
+	if(query == std::string::npos)
+		return "";
+
+	size_t start = query + 1;
+	while(start < target.size())
+	{
+		size_t end = target.find('&', start);
+		if(end == std::string::npos)
+			end = target.size();
+
+		if(target.compare(start, name.size() + 1, name + "=") == 0)
+			return urlDecode(target.substr(start + name.size() + 1, end - start - name.size() - 1));
+
+		start = end + 1;
+	}
+
+	return "";
+}
+
+// the names are generated by the benchmark, escaping the few special characters is enough
+static std::string escape(const std::string& _string, const bool xml)
+{
+	std::string escaped;
+
+	for(const char c : _string)
+	{
+		if(xml && c == '&')      escaped += "&amp;";
+		else if(xml && c == '<') escaped += "&lt;";
+		else if(xml && c == '>') escaped += "&gt;";
+		else if(!xml && (c == '"' || c == '\\'))
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+
+	return escaped;
+}
+
+static int getGameId(const std::string& name)
+{
+	unsigned int hash = 5381;
+	for(const char c : name)
+		hash = hash * 33 + (unsigned char)c;
+
+	return (int)(hash % 1000000) + 1;
+}
+
+// noisy gradient, compresses about as badly as real box art does
+static std::string generateImage(const int size)
+{
+	FIBITMAP* bitmap = FreeImage_Allocate(size, size, 24);
+	if(bitmap == nullptr)
+		return "";
+
+	unsigned int random = 12345;
+	for(int y = 0; y < size; y++)
+	{
+		BYTE* line = FreeImage_GetScanLine(bitmap, y);
+		for(int x = 0; x < size; x++)
+		{
+			random = random * 1103515245 + 12345;
+			line[x * 3 + 0] = (BYTE)((x * 255 / size) ^ ((random >> 16) & 0x3F));
+			line[x * 3 + 1] = (BYTE)((y * 255 / size) ^ ((random >> 20) & 0x3F));
+			line[x * 3 + 2] = (BYTE)(((x + y) * 127 / size) ^ ((random >> 24) & 0x3F));
+		}
+	}
+
+	std::string image;
+	FIMEMORY* memory = FreeImage_OpenMemory();
+	if(FreeImage_SaveToMemory(FIF_PNG, bitmap, memory))
+	{
+		BYTE* data = nullptr;
+		DWORD length = 0;
+		FreeImage_AcquireMemory(memory, &data, &length);
+		image.assign((const char*)data, length);
+	}
+
+	FreeImage_CloseMemory(memory);
+	FreeImage_Unload(bitmap);
+
+	return image;
+}
+
+MockScraperServer::MockScraperServer(const Config& config) : mConfig(config), mSocket(-1), mPort(0), mRunning(false), mBytesSent(0), mRequestCount(0)
+{
+}
+
+MockScraperServer::~MockScraperServer()
+{
+	stop();
+}
+
+bool MockScraperServer::start()
+{
+	mImage = generateImage(mConfig.imageSize);
+	if(mImage.empty())
+		return false;
+
+	mSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if(mSocket < 0)
+		return false;
+
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+
+	socklen_t length = sizeof(address);
+	if(bind(mSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(mSocket, 64) != 0 ||
+		getsockname(mSocket, (struct sockaddr*)&address, &length) != 0)
+	{
+		close(mSocket);
+		mSocket = -1;
+		return false;
+	}
+
+	mPort = ntohs(address.sin_port);
+	mRunning = true;
+	mAcceptThread = std::thread(&MockScraperServer::acceptConnections, this);
+
+	return true;
+}
+
+void MockScraperServer::stop()
+{
+	if(!mRunning)
+		return;
+
+	mRunning = false;
+	mAcceptThread.join();
+
+	// the accept thread is gone, nothing is added to mConnections anymore
+	for(auto it = mConnections.begin(); it != mConnections.end(); it++)
+		it->join();
+	mConnections.clear();
+
+	close(mSocket);
+	mSocket = -1;
+}
+
+std::string MockScraperServer::getUrl() const
+{
+	return "http://127.0.0.1:" + std::to_string(mPort);
+}
+
+void MockScraperServer::acceptConnections()
+{
+	while(mRunning)
+	{
+		struct pollfd listening = { mSocket, POLLIN, 0 };
+		if(poll(&listening, 1, POLL_TIMEOUT_MS) <= 0)
+			continue;
+
+		const int connection = accept(mSocket, nullptr, nullptr);
+		if(connection < 0)
+			continue;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mConnections.push_back(std::thread(&MockScraperServer::serveConnection, this, connection));
+	}
+}
+
+void MockScraperServer::serveConnection(int socket)
+{
+	std::string received;
+	char buffer[4096];
+
+	while(mRunning)
+	{
+		const size_t headerEnd = received.find("\r\n\r\n");
+		if(headerEnd == std::string::npos)
+		{
+			struct pollfd connection = { socket, POLLIN, 0 };
+			if(poll(&connection, 1, POLL_TIMEOUT_MS) <= 0)
+				continue;
+
+			const ssize_t count = recv(socket, buffer, sizeof(buffer), 0);
+			if(count <= 0)
+				break;
+
+			received.append(buffer, count);
+			continue;
+		}
+
+		// "GET /target HTTP/1.1", the scrapers only send GET requests without a body
+		const std::string requestLine = received.substr(0, received.find("\r\n"));
+		received.erase(0, headerEnd + 4);
+		mRequestCount++;
+
+		const size_t targetStart = requestLine.find(' ') + 1;
+		const std::string target = requestLine.substr(targetStart, requestLine.find(' ', targetStart) - targetStart);
+
+		std::string status;
+		std::string contentType;
+		std::string body;
+		getResponse(target, status, contentType, body);
+
+		if(mConfig.latency > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(mConfig.latency));
+
+		const std::string header = "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+			"\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+
+		if(!sendAll(socket, header) || !sendAll(socket, body))
+			break;
+	}
+
+	close(socket);
+}
+
+bool MockScraperServer::sendAll(int socket, const std::string& data)
+{
+	// without a limit everything goes at once, otherwise in slices of 10ms worth of data
+	const size_t slice = (mConfig.bandwidth > 0) ? std::max((size_t)mConfig.bandwidth * 1024 / 100, (size_t)1) : data.size();
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t sent = 0;
+
+	while(sent < data.size())
+	{
+		if(!mRunning)
+			return false;
+
+		const ssize_t count = send(socket, data.data() + sent, std::min(slice, data.size() - sent), MSG_NOSIGNAL);
+		if(count <= 0)
+			return false;
+
+		sent += count;
+		mBytesSent += count;
+
+		if(mConfig.bandwidth > 0)
+			std::this_thread::sleep_until(start + std::chrono::microseconds((long long)sent * 1000000 / ((long long)mConfig.bandwidth * 1024)));
+	}
+
+	return true;
+}
+
+void MockScraperServer::getResponse(const std::string& target, std::string& status, std::string& contentType, std::string& body)
+{
+	status = "200 OK";
+	contentType = "application/json";
+
+	if(target.compare(0, 10, "/v1/Games/") == 0)
+	{
+		// a search by id looks for the id given as name
+		const std::string name = getQueryParameter(target, "name");
+		body = getGamesDBGames(name.empty() ? getQueryParameter(target, "id") : name);
+	}
+	else if(target.compare(0, 14, "/v1/Developers") == 0)
+	{
+		body = getGamesDBResource("developers", "Mock Developer");
+	}
+	else if(target.compare(0, 14, "/v1/Publishers") == 0)
+	{
+		body = getGamesDBResource("publishers", "Mock Publisher");
+	}
+	else if(target.compare(0, 10, "/v1/Genres") == 0)
+	{
+		body = getGamesDBResource("genres", "Mock Genre");
+	}
+	else if(target.compare(0, 18, "/api2/jeuInfos.php") == 0)
+	{
+		contentType = "text/xml";
+		body = getScreenScraperGame(getQueryParameter(target, "romnom"));
+	}
+	else if(target.compare(0, 8, "/images/") == 0)
+	{
+		contentType = "image/png";
+		body = mImage;
+	}
+	else
+	{
+		status = "404 Not Found";
+		contentType = "text/plain";
+		body = "not found";
+	}
+}
+
+std::string MockScraperServer::getGamesDBGames(const std::string& name) const
+{
+	const std::string id = std::to_string(getGameId(name));
+	const std::string images = getUrl() + "/images/";
+
+	return "{\"code\":200,\"status\":\"Success\",\"data\":{\"count\":1,\"games\":[{\"id\":" + id +
+		",\"game_title\":\"" + escape(name, false) + "\",\"release_date\":\"1994-06-01\",\"platform\":6,\"players\":2" +
+		",\"overview\":\"Canned description of " + escape(name, false) + ", served by the mock scraper server.\"" +
+		",\"developers\":[1],\"publishers\":[1],\"genres\":[1]}]}," +
+		"\"include\":{\"boxart\":{\"base_url\":{\"thumb\":\"" + images + "thumb\",\"large\":\"" + images + "large\"}," +
+		"\"data\":{\"" + id + "\":[{\"id\":" + id + ",\"type\":\"boxart\",\"side\":\"front\",\"filename\":\"boxart/front/" + id + ".png\"}]}}}}";
+}
+
+std::string MockScraperServer::getGamesDBResource(const std::string& resource, const std::string& name) const
+{
+	return "{\"code\":200,\"status\":\"Success\",\"data\":{\"count\":1,\"" + resource + "\":{\"1\":{\"id\":1,\"name\":\"" + name + "\"}}}}";
+}
+
+std::string MockScraperServer::getScreenScraperGame(const std::string& name) const
+{
+	const std::string id = std::to_string(getGameId(name));
+
+	return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Data><jeu id=\"" + id + "\">" +
+		"<noms><nom region=\"wor\">" + escape(name, true) + "</nom></noms>" +
+		"<synopsis><synopsis langue=\"en\">Canned description of " + escape(name, true) + ", served by the mock scraper server.</synopsis></synopsis>" +
+		"<genres><genre langue=\"en\">Mock Genre</genre></genres>" +
+		"<dates><date region=\"wor\">1994-06-01</date></dates>" +
+		"<developpeur>Mock Developer</developpeur><editeur>Mock Publisher</editeur><joueurs>2</joueurs><note>16</note>" +
+		"<medias><media type=\"box-2D\" region=\"wor\" format=\"png\">" + getUrl() + "/images/media.php?gameid=" + id + "</media></medias>" +
+		"</jeu></Data>";
+}
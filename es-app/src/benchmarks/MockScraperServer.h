@@ -0,0 +1,61 @@
+#pragma once
+#ifndef ES_APP_BENCHMARKS_MOCK_SCRAPER_SERVER_H
+#define ES_APP_BENCHMARKS_MOCK_SCRAPER_SERVER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal HTTP/1.1 server on 127.0.0.1 answering like the scrapers' services, so they can be measured without
+// hitting the real ones. Point the scrapers at it with the "ScraperServer" setting. Every game name is found:
+// - "/v1/Games/...", "/v1/Developers", "/v1/Publishers" and "/v1/Genres" answer with TheGamesDB JSON
+// - "/api2/jeuInfos.php" answers with ScreenScraper XML
+// - "/images/..." answers with the same generated PNG image
+// Each connection is served by its own thread, keep-alive is supported. POSIX sockets only.
+class MockScraperServer
+{
+public:
+	struct Config
+	{
+		int latency   = 0;   // milliseconds before each response
+		int bandwidth = 0;   // KB/s per connection, 0 = unlimited
+		int imageSize = 512; // width and height of the served image
+	};
+
+	MockScraperServer(const Config& config);
+	~MockScraperServer();
+
+	bool start(); // listens on a free port
+	void stop();
+
+	std::string getUrl() const; // "http://127.0.0.1:port"
+	inline unsigned long long getBytesSent() const { return mBytesSent; }
+	inline unsigned int getRequestCount() const { return mRequestCount; }
+
+private:
+	void acceptConnections();
+	void serveConnection(int socket);
+	bool sendAll(int socket, const std::string& data);
+
+	void getResponse(const std::string& target, std::string& status, std::string& contentType, std::string& body);
+	std::string getGamesDBGames(const std::string& name) const;
+	std::string getGamesDBResource(const std::string& resource, const std::string& name) const;
+	std::string getScreenScraperGame(const std::string& name) const;
+
+	Config mConfig;
+	std::string mImage;
+
+	int mSocket;
+	int mPort;
+	std::atomic<bool> mRunning;
+	std::thread mAcceptThread;
+	std::mutex mMutex;
+	std::vector<std::thread> mConnections;
+
+	std::atomic<unsigned long long> mBytesSent;
+	std::atomic<unsigned int> mRequestCount;
+};
+
+#endif // ES_APP_BENCHMARKS_MOCK_SCRAPER_SERVER_H
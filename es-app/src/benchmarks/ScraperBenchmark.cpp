@@ -0,0 +1,307 @@
+// Scraper benchmark, scrapes a synthetic library in a scratch home folder against MockScraperServer and measures
+// the throughput of the scrape pipeline. The scrapers are pointed at the mock server with the "ScraperServer"
+// setting, so no real service is ever contacted. Results are reported as one JSON object per line on stdout.
+
+#include "benchmarks/MockScraperServer.h"
+#include "scrapers/ScraperPipeline.h"
+#include "utils/FileSystemUtil.h"
+#include "views/ViewController.h"
+#include "CollectionSystemManager.h"
+#include "FileData.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include "Window.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+struct BenchmarkParams
+{
+	int         systems   = 2;
+	int         games     = 250; // per system
+	std::string scraper   = "TheGamesDB";
+	int         latency   = 50;  // milliseconds the server waits before each response
+	int         bandwidth = 0;   // KB/s per connection, 0 = unlimited
+	int         imageSize = 512;
+	int         requests  = 4;   // ScraperMaxRequestsPerHost
+	int         resize    = 400; // ScraperResizeWidth, 0 = keep the downloaded images
+	int         poll      = 1;   // milliseconds between two pipeline updates, about 16 to mimic the UI
+	bool        cache     = false;
+	std::string path      = "./es-scraper-benchmark";
+};
+
+// known to both scrapers
+static const char* PLATFORMS[] = { "snes", "megadrive", "nes", "gba", "psx" };
+
+static const char* STAGE_NAMES[] = { "search", "download_wait", "download", "resize" };
+
+static bool generateLibrary(const BenchmarkParams& params)
+{
+	const std::string configPath = Utils::FileSystem::getHomePath() + "/configs/emulationstation";
+	const std::string romsPath   = Utils::FileSystem::getHomePath() + "/roms";
+
+	if(!Utils::FileSystem::createDirectory(configPath))
+		return false;
+
+	std::ofstream systemsFile(configPath + "/es_systems.cfg");
+	systemsFile << "<?xml version=\"1.0\"?>\n<systemList>\n";
+
+	for(int system = 0; system < params.systems; system++)
+	{
+		const std::string name       = "system" + std::to_string(system);
+		const std::string systemPath = romsPath + "/" + name;
+
+		systemsFile << "\t<system>\n";
+		systemsFile << "\t\t<name>" << name << "</name>\n";
+		systemsFile << "\t\t<fullname>Synthetic System " << system << "</fullname>\n";
+		systemsFile << "\t\t<path>" << systemPath << "</path>\n";
+		systemsFile << "\t\t<extension>.zip .ZIP</extension>\n";
+		systemsFile << "\t\t<command>true %ROM%</command>\n";
+		systemsFile << "\t\t<platform>" << PLATFORMS[system % (sizeof(PLATFORMS) / sizeof(PLATFORMS[0]))] << "</platform>\n";
+		systemsFile << "\t\t<theme>" << name << "</theme>\n";
+		systemsFile << "\t</system>\n";
+
+		if(!Utils::FileSystem::createDirectory(systemPath))
+			return false;
+
+		// no gamelist, every game is scraped
+		for(int game = 0; game < params.games; game++)
+			std::ofstream rom(systemPath + "/" + name + " Game " + std::to_string(game) + " (USA).zip");
+	}
+
+	systemsFile << "</systemList>\n";
+
+	return true;
+}
+
+static void reportPhase(const BenchmarkParams& params, const std::string& phase, const double wallMs, const std::string& extra = "")
+{
+	std::cout << "{\"benchmark\":\"scraper\",\"phase\":\"" << phase << "\"" <<
+		",\"systems\":" << params.systems <<
+		",\"games\":" << params.games <<
+		",\"scraper\":\"" << params.scraper << "\"" <<
+		",\"latency_ms\":" << params.latency <<
+		",\"bandwidth_kbs\":" << params.bandwidth <<
+		",\"image_size\":" << params.imageSize <<
+		",\"requests\":" << params.requests <<
+		",\"resize\":" << params.resize <<
+		",\"cache\":" << (params.cache ? "true" : "false") <<
+		",\"wall_ms\":" << wallMs <<
+		extra << "}" << std::endl;
+}
+
+static double getElapsedMs(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ",\"count\":N,\"avg_ms\":...,\"p50_ms\":...,\"p95_ms\":...,\"max_ms\":..."
+static std::string getLatencyStats(std::vector<Uint32>& times)
+{
+	if(times.empty())
+		return ",\"count\":0";
+
+	std::sort(times.begin(), times.end());
+
+	double total = 0;
+	for(auto time : times)
+		total += time;
+
+	return ",\"count\":" + std::to_string(times.size()) +
+		",\"avg_ms\":" + std::to_string(total / times.size()) +
+		",\"p50_ms\":" + std::to_string(times[times.size() / 2]) +
+		",\"p95_ms\":" + std::to_string(times[times.size() * 95 / 100]) +
+		",\"max_ms\":" + std::to_string(times.back());
+}
+
+static bool parseArgs(int argc, char* argv[], BenchmarkParams& params)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		if(i >= argc - 1)
+		{
+			std::cerr << "Missing value for " << argv[i] << "\n";
+			return false;
+		}
+
+		const char* value = argv[++i];
+
+		if(strcmp(argv[i - 1], "--systems") == 0)         params.systems   = atoi(value);
+		else if(strcmp(argv[i - 1], "--games") == 0)      params.games     = atoi(value);
+		else if(strcmp(argv[i - 1], "--scraper") == 0)    params.scraper   = value;
+		else if(strcmp(argv[i - 1], "--latency") == 0)    params.latency   = atoi(value);
+		else if(strcmp(argv[i - 1], "--bandwidth") == 0)  params.bandwidth = atoi(value);
+		else if(strcmp(argv[i - 1], "--image-size") == 0) params.imageSize = atoi(value);
+		else if(strcmp(argv[i - 1], "--requests") == 0)   params.requests  = atoi(value);
+		else if(strcmp(argv[i - 1], "--resize") == 0)     params.resize    = atoi(value);
+		else if(strcmp(argv[i - 1], "--poll") == 0)       params.poll      = atoi(value);
+		else if(strcmp(argv[i - 1], "--cache") == 0)      params.cache     = atoi(value) != 0;
+		else if(strcmp(argv[i - 1], "--path") == 0)       params.path      = value;
+		else
+		{
+			std::cerr << "Unknown option " << argv[i - 1] << "\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkParams params;
+
+	if(!parseArgs(argc, argv, params))
+	{
+		std::cerr << "usage: es-scraper-benchmark [--systems N] [--games N] [--scraper TheGamesDB|ScreenScraper] [--latency MS] [--bandwidth KB/s]\n" <<
+			"                            [--image-size PIXELS] [--requests N] [--resize WIDTH] [--poll MS] [--cache 0|1] [--path DIR]\n" <<
+			"The library is generated in DIR, which is reused as-is when it already contains one.\n";
+		return 1;
+	}
+
+	// the scratch folder is used as home so the user's own configuration is never touched
+	Utils::FileSystem::createDirectory(params.path);
+	Utils::FileSystem::setHomePath(Utils::FileSystem::getAbsolutePath(params.path));
+
+	const bool reuse = Utils::FileSystem::exists(Utils::FileSystem::getHomePath() + "/configs/emulationstation/es_systems.cfg");
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if(!reuse && !generateLibrary(params))
+	{
+		std::cerr << "Failed to generate the library in " << Utils::FileSystem::getHomePath() << "\n";
+		return 1;
+	}
+
+	reportPhase(params, "generate", getElapsedMs(start), reuse ? ",\"reused\":true" : ",\"reused\":false");
+
+	Log::init();
+	Log::open();
+
+	MockScraperServer::Config serverConfig;
+	serverConfig.latency   = params.latency;
+	serverConfig.bandwidth = params.bandwidth;
+	serverConfig.imageSize = params.imageSize;
+
+	MockScraperServer server(serverConfig);
+	if(!server.start())
+	{
+		std::cerr << "Failed to start the mock scraper server\n";
+		return 1;
+	}
+
+	Settings::getInstance()->setString("SaveGamelistsMode", "never");
+	Settings::getInstance()->setString("CollectionSystemsAuto", "");
+	Settings::getInstance()->setString("CollectionSystemsCustom", "");
+	Settings::getInstance()->setString("Scraper", params.scraper);
+	Settings::getInstance()->setString("ScraperServer", server.getUrl());
+	Settings::getInstance()->setInt("ScraperMaxRequestsPerHost", params.requests);
+	Settings::getInstance()->setInt("ScraperRequestInterval", 0);
+	Settings::getInstance()->setInt("ScraperResizeWidth", params.resize);
+	Settings::getInstance()->setInt("ScraperResizeHeight", 0);
+	Settings::getInstance()->setBool("HttpCache", params.cache);
+
+	// same setup as the command line scraper, the window is never initialized so nothing is rendered
+	Window window;
+	ViewController::init(&window);
+	CollectionSystemManager::init(&window);
+	window.pushGui(ViewController::get());
+
+	if(!SystemData::loadConfig(nullptr))
+	{
+		std::cerr << "Failed to load the generated es_systems.cfg\n";
+		return 1;
+	}
+
+	std::queue<ScraperSearchParams> searches;
+	for(auto system : SystemData::sSystemVector)
+	{
+		if(!system->isGameSystem() || system->isCollection())
+			continue;
+
+		FileData::FileIterator games(system->getRootFolder(), GAME);
+		while(FileData* game = games.next())
+		{
+			ScraperSearchParams search;
+			search.system = system;
+			search.game = game;
+			searches.push(search);
+		}
+	}
+
+	const unsigned int total = (unsigned int)searches.size();
+	unsigned int found = 0;
+	unsigned int errors = 0;
+	std::vector<Uint32> stageTimes[ScraperPipeline::DONE];
+	std::vector<Uint32> gameTimes;
+	std::vector<Uint32> resizeTimes;
+
+	start = std::chrono::steady_clock::now();
+
+	{
+		ScraperPipeline pipeline(searches);
+		std::vector<ScraperPipeline::Result> results;
+
+		while(!pipeline.isDone())
+		{
+			results.clear();
+			pipeline.update(results);
+
+			for(auto it = results.cbegin(); it != results.cend(); it++)
+			{
+				if(it->found)
+					found++;
+				else if(!it->error.empty())
+					errors++;
+
+				Uint32 gameTime = 0;
+				for(int stage = 0; stage < ScraperPipeline::DONE; stage++)
+				{
+					gameTime += it->stageTime[stage];
+					if(it->stageTime[stage] > 0 || stage == ScraperPipeline::SEARCHING)
+						stageTimes[stage].push_back(it->stageTime[stage]);
+				}
+				gameTimes.push_back(gameTime);
+
+				if(it->stageTime[ScraperPipeline::RESIZING] > 0)
+					resizeTimes.push_back(it->resizeTime);
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(params.poll));
+		}
+	}
+
+	const double wallMs = getElapsedMs(start);
+	const double seconds = wallMs / 1000.0;
+
+	reportPhase(params, "scrape", wallMs,
+		",\"scraped\":" + std::to_string(total) +
+		",\"found\":" + std::to_string(found) +
+		",\"errors\":" + std::to_string(errors) +
+		",\"http_requests\":" + std::to_string(server.getRequestCount()) +
+		",\"bytes\":" + std::to_string(server.getBytesSent()) +
+		",\"games_per_s\":" + std::to_string(seconds > 0 ? total / seconds : 0) +
+		",\"bytes_per_s\":" + std::to_string(seconds > 0 ? server.getBytesSent() / seconds : 0));
+
+	for(int stage = 0; stage < ScraperPipeline::DONE; stage++)
+		reportPhase(params, "stage", wallMs, std::string(",\"stage\":\"") + STAGE_NAMES[stage] + "\"" + getLatencyStats(stageTimes[stage]));
+
+	reportPhase(params, "stage", wallMs, ",\"stage\":\"resize_work\"" + getLatencyStats(resizeTimes));
+	reportPhase(params, "stage", wallMs, ",\"stage\":\"total\"" + getLatencyStats(gameTimes));
+
+	server.stop();
+
+	while(window.peekGui() != ViewController::get())
+		delete window.peekGui();
+
+	CollectionSystemManager::deinit();
+	SystemData::deleteSystems();
+
+	Log::close();
+
+	return 0;
+}
@@ -0,0 +1,317 @@
+// Startup benchmark, generates a synthetic library in a scratch home folder and measures how long
+// EmulationStation needs to load it. Each phase is reported as one JSON object per line on stdout.
+
+#include "utils/FileSystemUtil.h"
+#include "views/ViewController.h"
+#include "CollectionSystemManager.h"
+#include "FileData.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include "Window.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(WIN32)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+struct BenchmarkParams
+{
+	int         systems     = 10;
+	int         games       = 1000; // per system
+	int         depth       = 1;    // folder levels between the system root and the roms
+	int         metadata    = 2;    // 0 = no gamelist, 1 = names only, 2 = full text metadata, 3 = full metadata + media paths
+	int         collections = 4;    // custom collections
+	bool        threaded    = false;
+	std::string path        = "./es-startup-benchmark";
+};
+
+static const int FOLDER_FANOUT = 4;
+
+static long getPeakRSS()
+{
+#if defined(WIN32)
+	return 0;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+
+static long getCurrentRSS()
+{
+#if defined(__linux__)
+	long pages = 0;
+	long resident = 0;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if(file)
+	{
+		if(fscanf(file, "%ld %ld", &pages, &resident) != 2)
+			resident = 0;
+		fclose(file);
+	}
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+	return 0;
+#endif
+}
+
+static std::string getRomPath(const int game, const int depth)
+{
+	std::string path;
+	int bucket = game;
+
+	for(int level = 0; level < depth; level++)
+	{
+		path += "folder" + std::to_string(bucket % FOLDER_FANOUT) + "/";
+		bucket /= FOLDER_FANOUT;
+	}
+
+	return path + "game" + std::to_string(game) + ".zip";
+}
+
+static void writeGame(std::ofstream& out, const BenchmarkParams& params, const std::string& system, const int game)
+{
+	const std::string romPath = getRomPath(game, params.depth);
+
+	out << "\t<game>\n";
+	out << "\t\t<path>./" << romPath << "</path>\n";
+	out << "\t\t<name>" << system << " Game " << game << " (USA)</name>\n";
+
+	if(params.metadata >= 2)
+	{
+		out << "\t\t<desc>Synthetic game " << game << " of " << system << ", used to measure how long loading a large library takes. "
+			"The description is long enough to be representative of scraped data.</desc>\n";
+		out << "\t\t<rating>" << ((game % 11) / 10.0f) << "</rating>\n";
+		out << "\t\t<releasedate>" << (1980 + (game % 40)) << "0" << (1 + (game % 9)) << "15T000000</releasedate>\n";
+		out << "\t\t<developer>Developer " << (game % 97) << "</developer>\n";
+		out << "\t\t<publisher>Publisher " << (game % 53) << "</publisher>\n";
+		out << "\t\t<genre>Genre " << (game % 17) << "</genre>\n";
+		out << "\t\t<players>" << (1 + (game % 4)) << "</players>\n";
+
+		if((game % 10) == 0)
+			out << "\t\t<favorite>true</favorite>\n";
+
+		if((game % 7) == 0)
+		{
+			out << "\t\t<playcount>" << (game % 13) << "</playcount>\n";
+			out << "\t\t<lastplayed>20" << (10 + (game % 10)) << "0" << (1 + (game % 9)) << "01T1200" << (10 + (game % 50)) << "</lastplayed>\n";
+		}
+	}
+
+	if(params.metadata >= 3)
+	{
+		out << "\t\t<image>./media/images/game" << game << ".png</image>\n";
+		out << "\t\t<video>./media/videos/game" << game << ".mp4</video>\n";
+		out << "\t\t<marquee>./media/marquees/game" << game << ".png</marquee>\n";
+		out << "\t\t<thumbnail>./media/thumbnails/game" << game << ".png</thumbnail>\n";
+	}
+
+	out << "\t</game>\n";
+}
+
+static bool generateLibrary(const BenchmarkParams& params)
+{
+	const std::string configPath = Utils::FileSystem::getHomePath() + "/configs/emulationstation";
+	const std::string romsPath   = Utils::FileSystem::getHomePath() + "/roms";
+
+	if(!Utils::FileSystem::createDirectory(configPath + "/collections"))
+		return false;
+
+	std::ofstream systemsFile(configPath + "/es_systems.cfg");
+	systemsFile << "<?xml version=\"1.0\"?>\n<systemList>\n";
+
+	for(int system = 0; system < params.systems; system++)
+	{
+		const std::string name       = "system" + std::to_string(system);
+		const std::string systemPath = romsPath + "/" + name;
+
+		systemsFile << "\t<system>\n";
+		systemsFile << "\t\t<name>" << name << "</name>\n";
+		systemsFile << "\t\t<fullname>Synthetic System " << system << "</fullname>\n";
+		systemsFile << "\t\t<path>" << systemPath << "</path>\n";
+		systemsFile << "\t\t<extension>.zip .ZIP</extension>\n";
+		systemsFile << "\t\t<command>true %ROM%</command>\n";
+		systemsFile << "\t\t<platform>" << name << "</platform>\n";
+		systemsFile << "\t\t<theme>" << name << "</theme>\n";
+		systemsFile << "\t</system>\n";
+
+		for(int game = 0; game < params.games; game++)
+		{
+			const std::string romPath = systemPath + "/" + getRomPath(game, params.depth);
+
+			if(game < (1 << (2 * params.depth)) && !Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(romPath)))
+				return false;
+
+			std::ofstream rom(romPath);
+		}
+
+		if(params.metadata > 0)
+		{
+			const std::string gamelistPath = configPath + "/gamelists/" + name;
+
+			if(!Utils::FileSystem::createDirectory(gamelistPath))
+				return false;
+
+			std::ofstream gamelist(gamelistPath + "/gamelist.xml");
+			gamelist << "<?xml version=\"1.0\"?>\n<gameList>\n";
+
+			for(int game = 0; game < params.games; game++)
+				writeGame(gamelist, params, name, game);
+
+			gamelist << "</gameList>\n";
+		}
+	}
+
+	systemsFile << "</systemList>\n";
+
+	// every custom collection picks a different slice of all games
+	for(int collection = 0; collection < params.collections; collection++)
+	{
+		std::ofstream collectionFile(configPath + "/collections/custom-collection" + std::to_string(collection) + ".cfg");
+
+		for(int system = 0; system < params.systems; system++)
+		{
+			for(int game = collection; game < params.games; game += (params.collections + 1))
+				collectionFile << romsPath << "/system" << system << "/" << getRomPath(game, params.depth) << "\n";
+		}
+	}
+
+	return true;
+}
+
+static void reportPhase(const BenchmarkParams& params, const std::string& phase, const double wallMs, const std::string& extra = "")
+{
+	std::cout << "{\"benchmark\":\"startup\",\"phase\":\"" << phase << "\"" <<
+		",\"systems\":" << params.systems <<
+		",\"games\":" << params.games <<
+		",\"depth\":" << params.depth <<
+		",\"metadata\":" << params.metadata <<
+		",\"collections\":" << params.collections <<
+		",\"threaded\":" << (params.threaded ? "true" : "false") <<
+		",\"wall_ms\":" << wallMs <<
+		",\"rss_kb\":" << getCurrentRSS() <<
+		",\"peak_rss_kb\":" << getPeakRSS() <<
+		extra << "}" << std::endl;
+}
+
+static double getElapsedMs(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool parseArgs(int argc, char* argv[], BenchmarkParams& params)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		if(i >= argc - 1)
+		{
+			std::cerr << "Missing value for " << argv[i] << "\n";
+			return false;
+		}
+
+		const char* value = argv[++i];
+
+		if(strcmp(argv[i - 1], "--systems") == 0)          params.systems     = atoi(value);
+		else if(strcmp(argv[i - 1], "--games") == 0)       params.games       = atoi(value);
+		else if(strcmp(argv[i - 1], "--depth") == 0)       params.depth       = atoi(value);
+		else if(strcmp(argv[i - 1], "--metadata") == 0)    params.metadata    = atoi(value);
+		else if(strcmp(argv[i - 1], "--collections") == 0) params.collections = atoi(value);
+		else if(strcmp(argv[i - 1], "--threaded") == 0)    params.threaded    = atoi(value) != 0;
+		else if(strcmp(argv[i - 1], "--path") == 0)        params.path        = value;
+		else
+		{
+			std::cerr << "Unknown option " << argv[i - 1] << "\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkParams params;
+
+	if(!parseArgs(argc, argv, params))
+	{
+		std::cerr << "usage: es-startup-benchmark [--systems N] [--games N] [--depth N] [--metadata 0-3] [--collections N] [--threaded 0|1] [--path DIR]\n" <<
+			"The library is generated in DIR, which is reused as-is when it already contains one.\n";
+		return 1;
+	}
+
+	// the scratch folder is used as home so the user's own configuration is never touched
+	Utils::FileSystem::createDirectory(params.path);
+	Utils::FileSystem::setHomePath(Utils::FileSystem::getAbsolutePath(params.path));
+
+	const bool reuse = Utils::FileSystem::exists(Utils::FileSystem::getHomePath() + "/configs/emulationstation/es_systems.cfg");
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if(!reuse && !generateLibrary(params))
+	{
+		std::cerr << "Failed to generate the library in " << Utils::FileSystem::getHomePath() << "\n";
+		return 1;
+	}
+
+	reportPhase(params, "generate", getElapsedMs(start), reuse ? ",\"reused\":true" : ",\"reused\":false");
+
+	Log::init();
+	Log::open();
+
+	std::string customCollections;
+	for(int collection = 0; collection < params.collections; collection++)
+		customCollections += (collection ? ",collection" : "collection") + std::to_string(collection);
+
+	Settings::getInstance()->setString("SaveGamelistsMode", "never");
+	Settings::getInstance()->setString("CollectionSystemsAuto", "all,favorites,recent");
+	Settings::getInstance()->setString("CollectionSystemsCustom", customCollections);
+	Settings::getInstance()->setBool("ThreadedLoading", params.threaded);
+	Settings::getInstance()->setBool("ParseGamelistOnly", false);
+
+	// same setup as the command line scraper, the window is never initialized so nothing is rendered
+	Window window;
+	ViewController::init(&window);
+	CollectionSystemManager::init(&window);
+	window.pushGui(ViewController::get());
+
+	start = std::chrono::steady_clock::now();
+
+	if(!SystemData::loadConfig(nullptr))
+	{
+		std::cerr << "Failed to load the generated es_systems.cfg\n";
+		return 1;
+	}
+
+	int loadedGames = 0;
+	for(auto system : SystemData::sSystemVector)
+	{
+		if(system->isGameSystem() && !system->isCollection())
+			loadedGames += system->getRootFolder()->getGameCount();
+	}
+
+	const Utils::FileSystem::ExistsCacheStats existsStats = Utils::FileSystem::getExistsCacheStats();
+
+	reportPhase(params, "loadConfig", getElapsedMs(start), ",\"loaded_systems\":" + std::to_string(SystemData::sSystemVector.size()) + ",\"loaded_games\":" + std::to_string(loadedGames) +
+		",\"exists_hits\":" + std::to_string(existsStats.hits) + ",\"exists_misses\":" + std::to_string(existsStats.misses) +
+		",\"exists_cache_bytes\":" + std::to_string(existsStats.bytes));
+
+	start = std::chrono::steady_clock::now();
+
+	while(window.peekGui() != ViewController::get())
+		delete window.peekGui();
+
+	CollectionSystemManager::deinit();
+	SystemData::deleteSystems();
+
+	reportPhase(params, "shutdown", getElapsedMs(start));
+
+	Log::close();
+
+	return 0;
+}
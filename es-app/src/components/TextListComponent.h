@@ -49,6 +49,7 @@ public:
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
 	void add(const std::string& name, const T& obj, unsigned int colorId);
+	void insert(const std::string& name, const T& obj, unsigned int colorId, int index);
 
 	enum Alignment
 	{
@@ -378,6 +379,18 @@ void TextListComponent<T>::add(const std::string& name, const T& obj, unsigned i
 	static_cast<IList< TextListData, T >*>(this)->add(entry);
 }
 
+template <typename T>
+void TextListComponent<T>::insert(const std::string& name, const T& obj, unsigned int color, int index)
+{
+	assert(color < COLOR_ID_COUNT);
+
+	typename IList<TextListData, T>::Entry entry;
+	entry.name = name;
+	entry.object = obj;
+	entry.data.colorId = color;
+	static_cast<IList< TextListData, T >*>(this)->insert(entry, index);
+}
+
 template <typename T>
 void TextListComponent<T>::onCursorChanged(const CursorState& state)
 {
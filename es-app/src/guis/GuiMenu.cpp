@@ -349,6 +349,8 @@ void GuiMenu::openUISettings()
 		Settings::getInstance()->setBool("IgnoreLeadingArticles", ignore_articles->getState());
 		if (ignore_articles->getState() != articles_are_ignored)
 		{
+			FileSorts::invalidateSortKeys();
+
 			//For each system...
 			for (auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
 			{
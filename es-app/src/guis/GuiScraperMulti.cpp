@@ -11,6 +11,9 @@
 #include "SystemData.h"
 #include "Window.h"
 
+// every save rewrites the whole gamelist, scraped games are saved by batches of this size
+static const unsigned int SAVE_BATCH_SIZE = 50;
+
 GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchParams>& searches, bool approveResults) :
 	GuiComponent(window), mBackground(window, ":/frame.png"), mGrid(window, Vector2i(1, 5)),
 	mSearchQueue(searches)
@@ -27,6 +30,7 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	mCurrentGame = 0;
 	mTotalSuccessful = 0;
 	mTotalSkipped = 0;
+	mUnsavedGames = 0;
 
 	// set up grid
 	mTitle = std::make_shared<TextComponent>(mWindow, "SCRAPING IN PROGRESS", Font::get(FONT_SIZE_LARGE), 0x555555FF, ALIGN_CENTER);
@@ -38,12 +42,19 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	mSubtitle = std::make_shared<TextComponent>(mWindow, "subtitle text", Font::get(FONT_SIZE_SMALL), 0x888888FF, ALIGN_CENTER);
 	mGrid.setEntry(mSubtitle, Vector2i(0, 2), false, true);
 
-	mSearchComp = std::make_shared<ScraperSearchComponent>(mWindow,
-		approveResults ? ScraperSearchComponent::ALWAYS_ACCEPT_MATCHING_CRC : ScraperSearchComponent::ALWAYS_ACCEPT_FIRST_RESULT);
-	mSearchComp->setAcceptCallback(std::bind(&GuiScraperMulti::acceptResult, this, std::placeholders::_1));
-	mSearchComp->setSkipCallback(std::bind(&GuiScraperMulti::skip, this));
-	mSearchComp->setCancelCallback(std::bind(&GuiScraperMulti::finish, this));
-	mGrid.setEntry(mSearchComp, Vector2i(0, 3), mSearchComp->getSearchType() != ScraperSearchComponent::ALWAYS_ACCEPT_FIRST_RESULT, true);
+	if(approveResults)
+	{
+		mSearchComp = std::make_shared<ScraperSearchComponent>(mWindow, ScraperSearchComponent::ALWAYS_ACCEPT_MATCHING_CRC);
+		mSearchComp->setAcceptCallback(std::bind(&GuiScraperMulti::acceptResult, this, std::placeholders::_1));
+		mSearchComp->setSkipCallback(std::bind(&GuiScraperMulti::skip, this));
+		mSearchComp->setCancelCallback(std::bind(&GuiScraperMulti::finish, this));
+		mGrid.setEntry(mSearchComp, Vector2i(0, 3), true, true);
+	}
+	else
+	{
+		mPipelineStatus = std::make_shared<TextComponent>(mWindow, "", Font::get(FONT_SIZE_SMALL), 0x777777FF, ALIGN_CENTER);
+		mGrid.setEntry(mPipelineStatus, Vector2i(0, 3), false, true);
+	}
 
 	std::vector< std::shared_ptr<ButtonComponent> > buttons;
 
@@ -68,7 +79,17 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	setSize(Renderer::getScreenWidth() * 0.95f, Renderer::getScreenHeight() * 0.849f);
 	setPosition((Renderer::getScreenWidth() - mSize.x()) / 2, (Renderer::getScreenHeight() - mSize.y()) / 2);
 
-	doNextSearch();
+	if(approveResults)
+	{
+		doNextSearch();
+	}
+	else
+	{
+		// results are always accepted, nothing has to wait for the user
+		mPipeline = std::unique_ptr<ScraperPipeline>(new ScraperPipeline(mSearchQueue));
+		mSearchQueue = std::queue<ScraperSearchParams>();
+		mSystem->setText("");
+	}
 }
 
 GuiScraperMulti::~GuiScraperMulti()
@@ -89,6 +110,70 @@ void GuiScraperMulti::onSizeChanged()
 	mGrid.setSize(mSize);
 }
 
+void GuiScraperMulti::update(int deltaTime)
+{
+	GuiComponent::update(deltaTime);
+
+	if(!mPipeline)
+		return;
+
+	std::vector<ScraperPipeline::Result> results;
+	mPipeline->update(results);
+	commitResults(results);
+
+	if(mPipeline->isDone())
+	{
+		finish();
+		return;
+	}
+
+	std::stringstream ss;
+	ss << "GAME " << mCurrentGame << " OF " << mTotalGames;
+	if(mSubtitle->getValue() != ss.str())
+		mSubtitle->setText(ss.str());
+
+	ss.str(""); // clear
+	ss << "SEARCHING " << mPipeline->getSearchingCount() << " - DOWNLOADING " << mPipeline->getDownloadingCount() <<
+		" - RESIZING " << mPipeline->getResizingCount();
+	if(mPipelineStatus->getValue() != ss.str())
+		mPipelineStatus->setText(ss.str());
+}
+
+void GuiScraperMulti::commitResults(const std::vector<ScraperPipeline::Result>& results)
+{
+	for(auto it = results.cbegin(); it != results.cend(); it++)
+	{
+		mCurrentGame++;
+
+		if(!it->found)
+		{
+			mTotalSkipped++;
+			continue;
+		}
+
+		it->search.game->metadata = it->result.mdl;
+		mTotalSuccessful++;
+
+		if(std::find(mUnsavedSystems.cbegin(), mUnsavedSystems.cend(), it->search.system) == mUnsavedSystems.cend())
+			mUnsavedSystems.push_back(it->search.system);
+		mUnsavedGames++;
+
+		mSystem->setText(Utils::String::toUpper(it->search.system->getFullName()));
+	}
+
+	if(mUnsavedGames >= SAVE_BATCH_SIZE)
+		saveGamelists();
+}
+
+void GuiScraperMulti::saveGamelists()
+{
+	for(auto it = mUnsavedSystems.cbegin(); it != mUnsavedSystems.cend(); it++)
+		updateGamelist(*it);
+
+	mUnsavedSystems.clear();
+	mUnsavedGames = 0;
+}
+
 void GuiScraperMulti::doNextSearch()
 {
 	if(mSearchQueue.empty())
@@ -132,6 +217,10 @@ void GuiScraperMulti::skip()
 
 void GuiScraperMulti::finish()
 {
+	// the games still in progress are dropped, the ones already scraped are saved
+	mPipeline.reset();
+	saveGamelists();
+
 	std::stringstream ss;
 	if(mTotalSuccessful == 0)
 	{
@@ -5,6 +5,7 @@
 #include "components/ComponentGrid.h"
 #include "components/NinePatchComponent.h"
 #include "scrapers/Scraper.h"
+#include "scrapers/ScraperPipeline.h"
 #include "GuiComponent.h"
 
 class ScraperSearchComponent;
@@ -17,6 +18,7 @@ public:
 	virtual ~GuiScraperMulti();
 
 	void onSizeChanged() override;
+	void update(int deltaTime) override;
 	std::vector<HelpPrompt> getHelpPrompts() override;
 
 private:
@@ -24,6 +26,9 @@ private:
 	void skip();
 	void doNextSearch();
 
+	void commitResults(const std::vector<ScraperPipeline::Result>& results);
+	void saveGamelists();
+
 	void finish();
 
 	unsigned int mTotalGames;
@@ -32,6 +37,11 @@ private:
 	unsigned int mTotalSkipped;
 	std::queue<ScraperSearchParams> mSearchQueue;
 
+	// without approval the games are scraped by the pipeline, several at once
+	std::unique_ptr<ScraperPipeline> mPipeline;
+	std::vector<SystemData*> mUnsavedSystems;
+	unsigned int mUnsavedGames;
+
 	NinePatchComponent mBackground;
 	ComponentGrid mGrid;
 
@@ -39,6 +49,7 @@ private:
 	std::shared_ptr<TextComponent> mSystem;
 	std::shared_ptr<TextComponent> mSubtitle;
 	std::shared_ptr<ScraperSearchComponent> mSearchComp;
+	std::shared_ptr<TextComponent> mPipelineStatus;
 	std::shared_ptr<ComponentGrid> mButtonGrid;
 };
 
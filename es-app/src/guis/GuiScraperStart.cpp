@@ -78,13 +78,13 @@ std::queue<ScraperSearchParams> GuiScraperStart::getSearches(std::vector<SystemD
 	std::queue<ScraperSearchParams> queue;
 	for(auto sys = systems.cbegin(); sys != systems.cend(); sys++)
 	{
-		std::vector<FileData*> games = (*sys)->getRootFolder()->getFilesRecursive(GAME);
-		for(auto game = games.cbegin(); game != games.cend(); game++)
+		FileData::FileIterator games((*sys)->getRootFolder(), GAME);
+		while(FileData* game = games.next())
 		{
-			if(selector((*sys), (*game)))
+			if(selector((*sys), game))
 			{
 				ScraperSearchParams search;
-				search.game = *game;
+				search.game = game;
 				search.system = *sys;
 
 				queue.push(search);
@@ -8,6 +8,7 @@
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
 #include "EmulationStation.h"
+#include "HttpReq.h"
 #include "InputManager.h"
 #include "Log.h"
 #include "MameNames.h"
@@ -128,6 +129,16 @@ bool parseArgs(int argc, char* argv[])
 		}else if(strcmp(argv[i], "--draw-framerate") == 0)
 		{
 			Settings::getInstance()->setBool("DrawFramerate", true);
+		}else if(strcmp(argv[i], "--frame-times-csv") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "No frame time file supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("FrameTimesCSV", argv[i + 1]);
+			++i; // skip the argument value
 		}else if(strcmp(argv[i], "--no-exit") == 0)
 		{
 			Settings::getInstance()->setBool("ShowExit", false);
@@ -218,6 +229,8 @@ bool parseArgs(int argc, char* argv[])
 				"                               +R: Reload all UI views (theme, gamelist, system)\n"
 				"                               +T: Toggle textcomponent boundary box\n"
 				"--draw-framerate               display the framerate (p)\n"
+				"--frame-times-csv FILE         write the time spent in each frame phase\n"
+				"                               to FILE for offline analysis\n"
 				"--max-vram SIZE                maximum VRAM to use in MB before swapping,\n"
 				"                               use 0 for unlimited (p)\n"
 				"--show-hidden-files            show also hidden files of filesystem, no effect\n"
@@ -437,6 +450,7 @@ int main(int argc, char* argv[])
 
 		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event))
 		{
+			window.beginFramePhase(FRAME_PHASE_INPUT);
 			do
 			{
 				InputManager::getInstance()->parseEvent(event, &window);
@@ -444,6 +458,7 @@ int main(int argc, char* argv[])
 				if(event.type == SDL_QUIT)
 					running = false;
 			} while(SDL_PollEvent(&event));
+			window.endFramePhase(FRAME_PHASE_INPUT);
 
 			// triggered if exiting from SDL_WaitEvent due to event
 			if (ps_standby)
@@ -475,9 +490,19 @@ int main(int argc, char* argv[])
 		if(deltaTime < 0)
 			deltaTime = 1000;
 
+		window.beginFramePhase(FRAME_PHASE_UPDATE);
 		window.update(deltaTime);
+		window.endFramePhase(FRAME_PHASE_UPDATE);
+
+		window.beginFramePhase(FRAME_PHASE_RENDER);
 		window.render();
+		window.endFramePhase(FRAME_PHASE_RENDER);
+
+		window.beginFramePhase(FRAME_PHASE_SWAP);
 		Renderer::swapBuffers();
+		window.endFramePhase(FRAME_PHASE_SWAP);
+
+		window.endFrame();
 
 		Log::flush();
 	}
@@ -491,6 +516,7 @@ int main(int argc, char* argv[])
 	MameNames::deinit();
 	CollectionSystemManager::deinit();
 	SystemData::deleteSystems();
+	HttpReq::shutdown();
 
 	// call this ONLY when linking with FreeImage as a static library
 #ifdef FREEIMAGE_LIB
@@ -1,11 +1,16 @@
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <memory>
+#include <sstream>
+#include <stdint.h>
 #include <thread>
+#include <vector>
 
 #include "Log.h"
 
 #include "scrapers/GamesDBJSONScraperResources.h"
+#include "scrapers/Scraper.h"
 #include "utils/FileSystemUtil.h"
 
 
@@ -25,13 +30,36 @@ constexpr int POLL_TIME_MS = 500;
 constexpr int MAX_WAIT_ITER = MAX_WAIT_MS / POLL_TIME_MS;
 
 constexpr char SCRAPER_RESOURCES_DIR[] = "scrapers";
-constexpr char DEVELOPERS_JSON_FILE[] = "gamesdb_developers.json";
-constexpr char PUBLISHERS_JSON_FILE[] = "gamesdb_publishers.json";
-constexpr char GENRES_JSON_FILE[] = "gamesdb_genres.json";
 constexpr char DEVELOPERS_ENDPOINT[] = "/Developers";
 constexpr char PUBLISHERS_ENDPOINT[] = "/Publishers";
 constexpr char GENRES_ENDPOINT[] = "/Genres";
 
+// Table file: a header, the hash index, the entries sorted by id and their names one after the other.
+// Each bucket of the index holds an entry's position + 1, 0 for an empty one, collisions go to the next bucket.
+// Written in the native byte order, a file from another one fails the magic number check and is fetched again.
+constexpr uint32_t TABLE_MAGIC = 0x54524745; // "EGRT"
+constexpr uint32_t TABLE_VERSION = 1;
+
+struct TableHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t bucketCount; // a power of two, at least twice count so there is always an empty bucket
+};
+
+struct TableEntry
+{
+	int32_t id;
+	uint32_t nameOffset;
+	uint32_t nameLength;
+};
+
+uint32_t hashId(int id)
+{
+	return (uint32_t)id * 2654435761u;
+}
+
 std::string genFilePath(const std::string& file_name)
 {
 	return Utils::FileSystem::getGenericPath(getScrapersResouceDir() + "/" + file_name);
@@ -53,145 +81,214 @@ std::string getScrapersResouceDir()
 		Utils::FileSystem::getHomePath() + "/configs/emulationstation/" + SCRAPER_RESOURCES_DIR);
 }
 
-std::string TheGamesDBJSONRequestResources::getApiKey() const { return GamesDBAPIKey; }
-
+GamesDBResourceTable::GamesDBResourceTable(const std::string& name, const std::string& endpoint)
+	: mName(name), mEndpoint(endpoint), mMapped(false), mRefreshed(false)
+{
+}
 
-void TheGamesDBJSONRequestResources::prepare()
+bool GamesDBResourceTable::map()
 {
-	if (checkLoaded())
-	{
-		return;
-	}
+	mMapped = true;
+	mPath = genFilePath("gamesdb_" + mName + ".bin");
 
-	if (loadResource(gamesdb_new_developers_map, "developers", genFilePath(DEVELOPERS_JSON_FILE)) &&
-		!gamesdb_developers_resource_request)
+	if (!mFile.open(mPath))
 	{
-		gamesdb_developers_resource_request = fetchResource(DEVELOPERS_ENDPOINT);
+		return false;
 	}
-	if (loadResource(gamesdb_new_publishers_map, "publishers", genFilePath(PUBLISHERS_JSON_FILE)) &&
-		!gamesdb_publishers_resource_request)
-	{
-		gamesdb_publishers_resource_request = fetchResource(PUBLISHERS_ENDPOINT);
-	}
-	if (loadResource(gamesdb_new_genres_map, "genres", genFilePath(GENRES_JSON_FILE)) && !gamesdb_genres_resource_request)
+
+	const TableHeader* header = (const TableHeader*)mFile.getData();
+	if (mFile.getSize() < sizeof(TableHeader) || header->magic != TABLE_MAGIC || header->version != TABLE_VERSION ||
+		header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0 ||
+		header->bucketCount <= header->count ||
+		mFile.getSize() < sizeof(TableHeader) + header->bucketCount * sizeof(uint32_t) + header->count * sizeof(TableEntry))
 	{
-		gamesdb_genres_resource_request = fetchResource(GENRES_ENDPOINT);
+		LOG(LogWarning) << "TheGamesDB resource file " << mPath << " is invalid, fetching it again";
+		mFile.close();
+		return false;
 	}
+
+	return true;
 }
 
-void TheGamesDBJSONRequestResources::ensureResources()
+bool GamesDBResourceTable::isLoaded()
 {
-
-	if (checkLoaded())
+	if (!mMapped)
 	{
-		return;
+		map();
 	}
+	return mFile.isOpen();
+}
 
+bool GamesDBResourceTable::find(int id, std::string& name)
+{
+	// a refresh may have completed since the last lookup
+	update();
 
-	for (int i = 0; i < MAX_WAIT_ITER; ++i)
+	if (isLoaded())
 	{
-		if (gamesdb_developers_resource_request &&
-			saveResource(gamesdb_developers_resource_request.get(), gamesdb_new_developers_map, "developers",
-				genFilePath(DEVELOPERS_JSON_FILE)))
-		{
-
-			gamesdb_developers_resource_request.reset(nullptr);
-		}
-		if (gamesdb_publishers_resource_request &&
-			saveResource(gamesdb_publishers_resource_request.get(), gamesdb_new_publishers_map, "publishers",
-				genFilePath(PUBLISHERS_JSON_FILE)))
+		const TableHeader* header = (const TableHeader*)mFile.getData();
+		const uint32_t* buckets = (const uint32_t*)(header + 1);
+		const TableEntry* entries = (const TableEntry*)(buckets + header->bucketCount);
+		const char* names = (const char*)(entries + header->count);
+		const size_t namesSize = mFile.getSize() - (names - mFile.getData());
+		const uint32_t mask = header->bucketCount - 1;
+
+		// map() only checked the header, a damaged index may have no empty bucket to stop at
+		bool damaged = true;
+		uint32_t bucket = hashId(id) & mask;
+		for (uint32_t probe = 0; probe < header->bucketCount; ++probe, bucket = (bucket + 1) & mask)
 		{
-			gamesdb_publishers_resource_request.reset(nullptr);
+			if (buckets[bucket] == 0)
+			{
+				damaged = false;
+				break;
+			}
+			if (buckets[bucket] > header->count)
+			{
+				break;
+			}
+
+			const TableEntry& entry = entries[buckets[bucket] - 1];
+			if (entry.id == id)
+			{
+				if ((size_t)entry.nameOffset + entry.nameLength > namesSize)
+				{
+					break;
+				}
+				name.assign(names + entry.nameOffset, entry.nameLength);
+				return true;
+			}
 		}
-		if (gamesdb_genres_resource_request && saveResource(gamesdb_genres_resource_request.get(), gamesdb_new_genres_map,
-												   "genres", genFilePath(GENRES_JSON_FILE)))
+
+		if (damaged)
 		{
-			gamesdb_genres_resource_request.reset(nullptr);
+			LOG(LogWarning) << "TheGamesDB resource file " << mPath << " is invalid, fetching it again";
+			mFile.close();
+			if (!mRequest)
+			{
+				fetch();
+			}
+			return false;
 		}
+	}
 
-		if (!gamesdb_developers_resource_request && !gamesdb_publishers_resource_request && !gamesdb_genres_resource_request)
+	// newer than the table, the next games will have it
+	if (!mRefreshed && !mRequest)
+	{
+		LOG(LogInfo) << "TheGamesDB " << mName << " id " << id << " unknown, refreshing the table";
+		fetch();
+	}
+	return false;
+}
+
+void GamesDBResourceTable::prepare()
+{
+	if (isLoaded() || mRequest)
+	{
+		return;
+	}
+
+	// older versions kept the whole json response, it is converted once
+	const std::string jsonPath = genFilePath("gamesdb_" + mName + ".json");
+	std::ifstream json(jsonPath);
+	if (json.good())
+	{
+		std::stringstream buffer;
+		buffer << json.rdbuf();
+		json.close();
+
+		if (merge(buffer.str()) > 0)
 		{
+			std::remove(jsonPath.c_str());
 			return;
 		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIME_MS));
 	}
-	LOG(LogError) << "Timed out while waiting for resources\n";
+
+	fetch();
 }
 
-bool TheGamesDBJSONRequestResources::checkLoaded()
+void GamesDBResourceTable::fetch()
 {
-	return !gamesdb_new_genres_map.empty() && !gamesdb_new_developers_map.empty() && !gamesdb_new_publishers_map.empty();
+	mRefreshed = true;
+
+	const std::string url = getScraperUrl("https://api.thegamesdb.net/v1") + mEndpoint + "?apikey=" + GamesDBAPIKey;
+
+	// a cached response would be the one the table was made from
+	HttpCache* cache = HttpCache::get();
+	if (cache)
+	{
+		cache->expire(url);
+	}
+
+	mRequest = std::unique_ptr<HttpReq>(new HttpReq(url));
 }
 
-bool TheGamesDBJSONRequestResources::saveResource(HttpReq* req, std::unordered_map<int, std::string>& resource,
-	const std::string& resource_name, const std::string& file_name)
+bool GamesDBResourceTable::update()
 {
-
-	if (req == nullptr)
+	if (!mRequest)
 	{
-		LOG(LogError) << "Http request pointer was null\n";
 		return true;
 	}
-	if (req->status() == HttpReq::REQ_IN_PROGRESS)
+
+	const HttpReq::Status status = mRequest->status();
+	if (status == HttpReq::REQ_IN_PROGRESS)
 	{
 		return false; // Not ready: wait some more
 	}
-	if (req->status() != HttpReq::REQ_SUCCESS)
+
+	if (status == HttpReq::REQ_SUCCESS)
 	{
-		LOG(LogError) << "Resource request for " << file_name << " failed:\n\t" << req->getErrorMsg();
-		return true; // Request failed, resetting request.
+		const int added = merge(mRequest->getContent());
+		LOG(LogInfo) << "TheGamesDB " << mName << " table: " << added << " new entries";
+	} else
+	{
+		LOG(LogError) << "Resource request for " << mName << " failed:\n\t" << mRequest->getErrorMsg();
 	}
 
-	ensureScrapersResourcesDir();
-
-	std::ofstream fout(file_name);
-	fout << req->getContent();
-	fout.close();
-	loadResource(resource, resource_name, file_name);
+	mRequest.reset(nullptr);
 	return true;
 }
 
-std::unique_ptr<HttpReq> TheGamesDBJSONRequestResources::fetchResource(const std::string& endpoint)
-{
-	std::string path = "https://api.thegamesdb.net/v1";
-	path += endpoint;
-	path += "?apikey=" + getApiKey();
-
-	return std::unique_ptr<HttpReq>(new HttpReq(path));
-}
-
-
-int TheGamesDBJSONRequestResources::loadResource(
-	std::unordered_map<int, std::string>& resource, const std::string& resource_name, const std::string& file_name)
+int GamesDBResourceTable::merge(const std::string& json)
 {
-
-
-	std::ifstream fin(file_name);
-	if (!fin.good())
-	{
-		return 1;
-	}
-	std::stringstream buffer;
-	buffer << fin.rdbuf();
 	Document doc;
-	doc.Parse(buffer.str().c_str());
+	doc.Parse(json.c_str());
 
 	if (doc.HasParseError())
 	{
-		std::string err = std::string("TheGamesDBJSONRequest - Error parsing JSON for resource file ") + file_name +
-						  ":\n\t" + GetParseError_En(doc.GetParseError());
+		std::string err = std::string("TheGamesDBJSONRequest - Error parsing JSON for resource ") + mName + ":\n\t" +
+						  GetParseError_En(doc.GetParseError());
 		LOG(LogError) << err;
-		return 1;
+		return 0;
 	}
 
-	if (!doc.HasMember("data") || !doc["data"].HasMember(resource_name.c_str()) ||
-		!doc["data"][resource_name.c_str()].IsObject())
+	if (!doc.HasMember("data") || !doc["data"].HasMember(mName.c_str()) || !doc["data"][mName.c_str()].IsObject())
 	{
 		std::string err = "TheGamesDBJSONRequest - Response had no resource data.\n";
 		LOG(LogError) << err;
-		return 1;
+		return 0;
+	}
+
+	// the whole table is rewritten, starting with what it already has
+	std::map<int, std::string> entries;
+	if (isLoaded())
+	{
+		const TableHeader* header = (const TableHeader*)mFile.getData();
+		const TableEntry* entry = (const TableEntry*)((const uint32_t*)(header + 1) + header->bucketCount);
+		const char* names = (const char*)(entry + header->count);
+		const size_t namesSize = mFile.getSize() - (names - mFile.getData());
+
+		for (uint32_t i = 0; i < header->count; ++i, ++entry)
+		{
+			if ((size_t)entry->nameOffset + entry->nameLength <= namesSize)
+			{
+				entries[entry->id] = std::string(names + entry->nameOffset, entry->nameLength);
+			}
+		}
 	}
-	auto& data = doc["data"][resource_name.c_str()];
+
+	int added = 0;
+	auto& data = doc["data"][mName.c_str()];
 
 	for (Value::ConstMemberIterator itr = data.MemberBegin(); itr != data.MemberEnd(); ++itr)
 	{
@@ -201,7 +298,114 @@ int TheGamesDBJSONRequestResources::loadResource(
 		{
 			continue;
 		}
-		resource[entry["id"].GetInt()] = entry["name"].GetString();
+		if (entries.insert(std::make_pair(entry["id"].GetInt(), std::string(entry["name"].GetString()))).second)
+		{
+			++added;
+		}
+	}
+
+	if (added > 0 && !write(entries))
+	{
+		return 0;
+	}
+	return added;
+}
+
+bool GamesDBResourceTable::write(const std::map<int, std::string>& entries)
+{
+	TableHeader header;
+	header.magic = TABLE_MAGIC;
+	header.version = TABLE_VERSION;
+	header.count = (uint32_t)entries.size();
+	header.bucketCount = 2;
+	while (header.bucketCount < header.count * 2)
+	{
+		header.bucketCount *= 2;
+	}
+
+	std::vector<uint32_t> buckets(header.bucketCount, 0);
+	std::vector<TableEntry> tableEntries;
+	std::string names;
+	tableEntries.reserve(entries.size());
+
+	for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+	{
+		TableEntry entry = { it->first, (uint32_t)names.size(), (uint32_t)it->second.size() };
+		tableEntries.push_back(entry);
+		names += it->second;
+
+		uint32_t bucket = hashId(it->first) & (header.bucketCount - 1);
+		while (buckets[bucket] != 0)
+		{
+			bucket = (bucket + 1) & (header.bucketCount - 1);
+		}
+		buckets[bucket] = (uint32_t)tableEntries.size();
+	}
+
+	ensureScrapersResourcesDir();
+
+	// written next to the table and renamed over it, the current mapping stays valid until it is closed
+	const std::string temporaryPath = mPath + ".tmp";
+	std::ofstream fout(temporaryPath, std::ios::binary | std::ios::trunc);
+	fout.write((const char*)&header, sizeof(header));
+	fout.write((const char*)buckets.data(), buckets.size() * sizeof(uint32_t));
+	fout.write((const char*)tableEntries.data(), tableEntries.size() * sizeof(TableEntry));
+	fout.write(names.data(), names.size());
+	fout.close();
+
+	mFile.close();
+
+	if (fout.fail())
+	{
+		LOG(LogError) << "Could not write TheGamesDB resource file " << temporaryPath;
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+#if defined(_WIN32)
+	std::remove(mPath.c_str());
+#endif
+	if (std::rename(temporaryPath.c_str(), mPath.c_str()) != 0)
+	{
+		LOG(LogError) << "Could not replace TheGamesDB resource file " << mPath;
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	return map();
+}
+
+TheGamesDBJSONRequestResources::TheGamesDBJSONRequestResources()
+	: developers("developers", DEVELOPERS_ENDPOINT), publishers("publishers", PUBLISHERS_ENDPOINT), genres("genres", GENRES_ENDPOINT)
+{
+}
+
+std::string TheGamesDBJSONRequestResources::getApiKey() const { return GamesDBAPIKey; }
+
+
+void TheGamesDBJSONRequestResources::prepare()
+{
+	developers.prepare();
+	publishers.prepare();
+	genres.prepare();
+}
+
+void TheGamesDBJSONRequestResources::ensureResources()
+{
+	for (int i = 0; i < MAX_WAIT_ITER; ++i)
+	{
+		// only a table that isn't there at all is waited for, a refresh completes in the background
+		bool done = true;
+		for (GamesDBResourceTable* table : { &developers, &publishers, &genres })
+		{
+			done &= (table->update() || table->isLoaded());
+		}
+
+		if (done)
+		{
+			return;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIME_MS));
 	}
-	return resource.empty();
+	LOG(LogError) << "Timed out while waiting for resources\n";
 }
@@ -2,39 +2,56 @@
 #ifndef ES_APP_SCRAPERS_GAMES_DB_JSON_SCRAPER_RESOURCES_H
 #define ES_APP_SCRAPERS_GAMES_DB_JSON_SCRAPER_RESOURCES_H
 
-#include <fstream>
+#include <map>
 #include <memory>
 #include <string>
-#include <unordered_map>
 
+#include "utils/MappedFile.h"
 #include "HttpReq.h"
 
 
-struct TheGamesDBJSONRequestResources
+// id -> name table of one TheGamesDB resource, "developers", "publishers" or "genres".
+// The table is kept in a compact binary file with a hash index, mapped in memory on its first lookup,
+// so nothing is parsed and only the pages holding the looked up names are ever read.
+// An id missing from the table refreshes it once per run, only the entries it doesn't have yet are added.
+class GamesDBResourceTable
 {
-	TheGamesDBJSONRequestResources() = default;
+public:
+	GamesDBResourceTable(const std::string& name, const std::string& endpoint);
 
-	void prepare();
-	void ensureResources();
-	std::string getApiKey() const;
+	bool find(int id, std::string& name);
+
+	void prepare(); // starts fetching the table when there is none
+	bool update();  // adds what was fetched, returns true once nothing is being fetched anymore
+	bool isLoaded();
+
+private:
+	bool map();
+	void fetch();
+	int merge(const std::string& json);
+	bool write(const std::map<int, std::string>& entries);
 
-	std::unordered_map<int, std::string> gamesdb_new_developers_map;
-	std::unordered_map<int, std::string> gamesdb_new_publishers_map;
-	std::unordered_map<int, std::string> gamesdb_new_genres_map;
+	std::string mName;
+	std::string mEndpoint;
+	std::string mPath;
 
-  private:
-	bool checkLoaded();
+	Utils::MappedFile mFile;
+	bool mMapped; // map() was tried
+	std::unique_ptr<HttpReq> mRequest;
+	bool mRefreshed;
+};
 
-	bool saveResource(HttpReq* req, std::unordered_map<int, std::string>& resource, const std::string& resource_name,
-		const std::string& file_name);
-	std::unique_ptr<HttpReq> fetchResource(const std::string& endpoint);
+struct TheGamesDBJSONRequestResources
+{
+	TheGamesDBJSONRequestResources();
 
-	int loadResource(
-		std::unordered_map<int, std::string>& resource, const std::string& resource_name, const std::string& file_name);
+	void prepare();
+	void ensureResources();
+	std::string getApiKey() const;
 
-	std::unique_ptr<HttpReq> gamesdb_developers_resource_request;
-	std::unique_ptr<HttpReq> gamesdb_publishers_resource_request;
-	std::unique_ptr<HttpReq> gamesdb_genres_resource_request;
+	GamesDBResourceTable developers;
+	GamesDBResourceTable publishers;
+	GamesDBResourceTable genres;
 };
 
 std::string getScrapersResouceDir();
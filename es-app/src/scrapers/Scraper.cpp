@@ -1,5 +1,7 @@
 #include "scrapers/Scraper.h"
 
+#include "math/Misc.h"
+#include "utils/ThreadPool.h"
 #include "FileData.h"
 #include "GamesDBJSONScraper.h"
 #include "ScreenScraper.h"
@@ -7,7 +9,12 @@
 #include "Settings.h"
 #include "SystemData.h"
 #include <FreeImage.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
+#include <math.h>
+#include <thread>
 
 const std::map<std::string, generate_scraper_requests_func> scraper_request_funcs {
 	{ "TheGamesDB", &thegamesdb_generate_json_scraper_requests },
@@ -43,6 +50,27 @@ std::vector<std::string> getScraperList()
 	return list;
 }
 
+std::string getScraperUrl(const std::string& url)
+{
+	const std::string& server = Settings::getInstance()->getString("ScraperServer");
+	if(server.empty())
+		return url;
+
+	size_t start = url.find("://");
+	start = (start == std::string::npos) ? 0 : start + 3;
+
+	const size_t path = url.find_first_of("/?", start);
+	return server + (path == std::string::npos ? "" : url.substr(path));
+}
+
+std::string getScraperSearchUrl()
+{
+	if(Settings::getInstance()->getString("Scraper") == "ScreenScraper")
+		return ScreenScraperRequest::configuration.getGameSearchUrl("");
+
+	return getScraperUrl("https://api.thegamesdb.net/v1");
+}
+
 bool isValidConfiguredScraper()
 {
 	const std::string& name = Settings::getInstance()->getString("Scraper");
@@ -134,12 +162,12 @@ void ScraperHttpRequest::update()
 
 // metadata resolving stuff
 
-std::unique_ptr<MDResolveHandle> resolveMetaDataAssets(const ScraperSearchResult& result, const ScraperSearchParams& search)
+std::unique_ptr<MDResolveHandle> resolveMetaDataAssets(const ScraperSearchResult& result, const ScraperSearchParams& search, bool resize)
 {
-	return std::unique_ptr<MDResolveHandle>(new MDResolveHandle(result, search));
+	return std::unique_ptr<MDResolveHandle>(new MDResolveHandle(result, search, resize));
 }
 
-MDResolveHandle::MDResolveHandle(const ScraperSearchResult& result, const ScraperSearchParams& search) : mResult(result)
+MDResolveHandle::MDResolveHandle(const ScraperSearchResult& result, const ScraperSearchParams& search, bool resize) : mResult(result)
 {
 	if(!result.imageUrl.empty())
 	{
@@ -160,7 +188,7 @@ MDResolveHandle::MDResolveHandle(const ScraperSearchResult& result, const Scrape
 
 		std::string imgPath = getSaveAsPath(search, "image", ext);
 
-		mFuncs.push_back(ResolvePair(downloadImageAsync(result.imageUrl, imgPath), [this, imgPath]
+		mFuncs.push_back(ResolvePair(downloadImageAsync(result.imageUrl, imgPath, resize), [this, imgPath]
 		{
 			mResult.mdl.set("image", imgPath);
 			mResult.imageUrl = "";
@@ -193,22 +221,39 @@ void MDResolveHandle::update()
 		setStatus(ASYNC_DONE);
 }
 
-std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url, const std::string& saveAs)
+std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url, const std::string& saveAs, bool resize)
 {
+	// a size of 0x0 leaves the image untouched
 	return std::unique_ptr<ImageDownloadHandle>(new ImageDownloadHandle(url, saveAs,
-		Settings::getInstance()->getInt("ScraperResizeWidth"), Settings::getInstance()->getInt("ScraperResizeHeight")));
+		resize ? Settings::getInstance()->getInt("ScraperResizeWidth") : 0, resize ? Settings::getInstance()->getInt("ScraperResizeHeight") : 0));
 }
 
 ImageDownloadHandle::ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight) :
-	mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight), mReq(new HttpReq(url))
+	mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight), mReq(new HttpReq(url, path))
 {
 }
 
 void ImageDownloadHandle::update()
 {
+	if(mResize)
+	{
+		const AsyncHandleStatus status = mResize->status();
+		if(status == ASYNC_IN_PROGRESS)
+			return;
+
+		if(status == ASYNC_ERROR)
+			setError(mResize->getStatusString());
+		else
+			setStatus(ASYNC_DONE);
+
+		mResize.reset();
+		return;
+	}
+
 	if(mReq->status() == HttpReq::REQ_IN_PROGRESS)
 		return;
 
+	// the image was written to disk while downloading
 	if(mReq->status() != HttpReq::REQ_SUCCESS)
 	{
 		std::stringstream ss;
@@ -217,31 +262,126 @@ void ImageDownloadHandle::update()
 		return;
 	}
 
-	// download is done, save it to disk
-	std::ofstream stream(mSavePath, std::ios_base::out | std::ios_base::binary);
-	if(stream.bad())
+	if(mMaxWidth == 0 && mMaxHeight == 0)
 	{
-		setError("Failed to open image path to write. Permission error? Disk full?");
+		setStatus(ASYNC_DONE);
 		return;
 	}
 
-	const std::string& content = mReq->getContent();
-	stream.write(content.data(), content.length());
-	stream.close();
-	if(stream.bad())
+	// resize it, off the main thread
+	mResize = std::unique_ptr<ImageResizeHandle>(new ImageResizeHandle(mSavePath, mMaxWidth, mMaxHeight));
+}
+
+// ImageResizeHandle
+struct ImageResizeHandle::Task
+{
+	std::string path;
+	int maxWidth;
+	int maxHeight;
+	std::atomic<bool> done;
+	bool success;
+	int time;
+
+	void run()
 	{
-		setError("Failed to save image. Disk full?");
-		return;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		success = resizeImage(path, maxWidth, maxHeight);
+		time = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		done = true;
 	}
+};
 
-	// resize it
-	if(!resizeImage(mSavePath, mMaxWidth, mMaxHeight))
+// an idle ThreadPool still wakes its workers up every millisecond, so it is released with the last handle
+static std::shared_ptr<Utils::ThreadPool> getResizePool()
+{
+	static std::weak_ptr<Utils::ThreadPool> sPool;
+
+	std::shared_ptr<Utils::ThreadPool> pool = sPool.lock();
+	if(!pool && std::thread::hardware_concurrency() > 2)
 	{
-		setError("Error saving resized image. Out of memory? Disk full?");
+		pool = std::make_shared<Utils::ThreadPool>();
+		sPool = pool;
+	}
+
+	return pool;
+}
+
+ImageResizeHandle::ImageResizeHandle(const std::string& path, int maxWidth, int maxHeight) : mPool(getResizePool()), mTask(std::make_shared<Task>())
+{
+	mTask->path = path;
+	mTask->maxWidth = maxWidth;
+	mTask->maxHeight = maxHeight;
+	mTask->done = false;
+	mTask->success = false;
+	mTask->time = 0;
+
+	setStatus(ASYNC_IN_PROGRESS);
+
+	// the task is shared with the worker, a handle deleted before it is done simply drops its result
+	std::shared_ptr<Task> task = mTask;
+	if(mPool)
+		mPool->queueWorkItem([task] { task->run(); });
+	else
+		task->run();
+}
+
+void ImageResizeHandle::update()
+{
+	if(mStatus != ASYNC_IN_PROGRESS || !mTask->done)
 		return;
+
+	if(mTask->success)
+		setStatus(ASYNC_DONE);
+	else
+		setError("Error saving resized image. Out of memory? Disk full?");
+}
+
+int ImageResizeHandle::getResizeTime() const
+{
+	return mTask->time;
+}
+
+// averages 2x2 blocks of pixels, a loop simple enough for the compiler to vectorize
+template<unsigned CHANNELS>
+static void halveImageLines(const BYTE* top, const BYTE* bottom, BYTE* out, const unsigned width)
+{
+	for(unsigned x = 0; x < width; x++)
+	{
+		for(unsigned c = 0; c < CHANNELS; c++)
+		{
+			const unsigned left = (x * 2) * CHANNELS + c;
+			const unsigned right = left + CHANNELS;
+			out[x * CHANNELS + c] = (BYTE)((top[left] + top[right] + bottom[left] + bottom[right] + 2) >> 2);
+		}
 	}
+}
 
-	setStatus(ASYNC_DONE);
+// returns NULL for the images it can't halve, anything but 24 and 32 bits RGB(A)
+static FIBITMAP* halveImage(FIBITMAP* image)
+{
+	const unsigned bpp = FreeImage_GetBPP(image);
+	if(FreeImage_GetImageType(image) != FIT_BITMAP || (bpp != 24 && bpp != 32))
+		return NULL;
+
+	const unsigned width = FreeImage_GetWidth(image) / 2;
+	const unsigned height = FreeImage_GetHeight(image) / 2;
+
+	FIBITMAP* halved = FreeImage_Allocate(width, height, bpp, FreeImage_GetRedMask(image), FreeImage_GetGreenMask(image), FreeImage_GetBlueMask(image));
+	if(halved == NULL)
+		return NULL;
+
+	for(unsigned y = 0; y < height; y++)
+	{
+		const BYTE* top = FreeImage_GetScanLine(image, y * 2);
+		const BYTE* bottom = FreeImage_GetScanLine(image, y * 2 + 1);
+
+		if(bpp == 32)
+			halveImageLines<4>(top, bottom, FreeImage_GetScanLine(halved, y), width);
+		else
+			halveImageLines<3>(top, bottom, FreeImage_GetScanLine(halved, y), width);
+	}
+
+	return halved;
 }
 
 //you can pass 0 for width or height to keep aspect ratio
@@ -251,6 +391,8 @@ bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
 	if(maxWidth == 0 && maxHeight == 0)
 		return true;
 
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
 	FREE_IMAGE_FORMAT format = FIF_UNKNOWN;
 	FIBITMAP* image = NULL;
 
@@ -264,15 +406,38 @@ bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
 		return false;
 	}
 
-	//make sure we can read this filetype first, then load it
-	if(FreeImage_FIFSupportsReading(format))
+	//make sure we can read this filetype first
+	if(!FreeImage_FIFSupportsReading(format))
 	{
-		image = FreeImage_Load(format, path.c_str());
-	}else{
 		LOG(LogError) << "Error - file format reading not supported for image \"" << path << "\"!";
 		return false;
 	}
 
+	// JPEGs are decoded straight at 1/2, 1/4 or 1/8 of their size by scaling in the DCT domain, the requested size is
+	// the one their larger side must keep so that neither side ends up smaller than the resized image
+	int flags = 0;
+	if(format == FIF_JPEG)
+	{
+		FIBITMAP* header = FreeImage_Load(format, path.c_str(), FIF_LOAD_NOPIXELS);
+		if(header != NULL)
+		{
+			const float width = (float)FreeImage_GetWidth(header);
+			const float height = (float)FreeImage_GetHeight(header);
+			FreeImage_Unload(header);
+
+			const float scale = (maxWidth == 0) ? (maxHeight / height) : (maxHeight == 0) ? (maxWidth / width) : Math::max(maxWidth / width, maxHeight / height);
+			if(scale < 0.5f)
+				flags = (int)ceilf(Math::max(width, height) * scale) << 16;
+		}
+	}
+
+	image = FreeImage_Load(format, path.c_str(), flags);
+	if(image == NULL)
+	{
+		LOG(LogError) << "Error - could not load image \"" << path << "\"!";
+		return false;
+	}
+
 	float width = (float)FreeImage_GetWidth(image);
 	float height = (float)FreeImage_GetHeight(image);
 
@@ -284,6 +449,17 @@ bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
 		maxHeight = (int)((maxWidth / width) * height);
 	}
 
+	// cheap halvings first, FreeImage_Rescale() then only filters an image less than twice the size it resizes to
+	while((int)FreeImage_GetWidth(image) / 2 >= maxWidth && (int)FreeImage_GetHeight(image) / 2 >= maxHeight)
+	{
+		FIBITMAP* halved = halveImage(image);
+		if(halved == NULL)
+			break;
+
+		FreeImage_Unload(image);
+		image = halved;
+	}
+
 	FIBITMAP* imageRescaled = FreeImage_Rescale(image, maxWidth, maxHeight, FILTER_BILINEAR);
 	FreeImage_Unload(image);
 
@@ -293,13 +469,31 @@ bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
 		return false;
 	}
 
-	bool saved = (FreeImage_Save(format, imageRescaled, path.c_str()) != 0);
+	// the image is never left half written, readers see either the downloaded or the resized one
+	const std::string temporaryPath = path + ".tmp";
+	bool saved = (FreeImage_Save(format, imageRescaled, temporaryPath.c_str()) != 0);
 	FreeImage_Unload(imageRescaled);
 
+	if(saved)
+	{
+#if defined(_WIN32)
+		// rename() doesn't replace an existing file there
+		std::remove(path.c_str());
+#endif
+		saved = (std::rename(temporaryPath.c_str(), path.c_str()) == 0);
+	}
+
 	if(!saved)
+	{
 		LOG(LogError) << "Failed to save resized image!";
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	LOG(LogDebug) << "Resized \"" << path << "\" to " << maxWidth << "x" << maxHeight << " in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms";
 
-	return saved;
+	return true;
 }
 
 std::string getSaveAsPath(const ScraperSearchParams& params, const std::string& suffix, const std::string& extension)
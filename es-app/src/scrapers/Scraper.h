@@ -15,6 +15,7 @@
 
 class FileData;
 class SystemData;
+namespace Utils { class ThreadPool; }
 
 struct ScraperSearchParams
 {
@@ -113,6 +114,13 @@ std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParam
 // returns a list of valid scraper names
 std::vector<std::string> getScraperList();
 
+// The url with its scheme, host and port replaced by the "ScraperServer" setting when it is set,
+// the path and query are kept. Used to point the scrapers at a local server, e.g. for benchmarks.
+std::string getScraperUrl(const std::string& url);
+
+// url the scraper configured in the settings searches with
+std::string getScraperSearchUrl();
+
 // returns true if the scraper configured in the settings is still valid
 bool isValidConfiguredScraper();
 
@@ -126,7 +134,7 @@ typedef void (*generate_scraper_requests_func)(const ScraperSearchParams& params
 class MDResolveHandle : public AsyncHandle
 {
 public:
-	MDResolveHandle(const ScraperSearchResult& result, const ScraperSearchParams& search);
+	MDResolveHandle(const ScraperSearchResult& result, const ScraperSearchParams& search, bool resize);
 
 	void update() override;
 	inline const ScraperSearchResult& getResult() const { assert(mStatus == ASYNC_DONE); return mResult; }
@@ -138,6 +146,23 @@ private:
 	std::vector<ResolvePair> mFuncs;
 };
 
+// Resizes an image with resizeImage() on worker threads shared by every handle, they only exist while a handle does.
+// Without enough cores for the workers the image is resized right away, by the constructor.
+class ImageResizeHandle : public AsyncHandle
+{
+public:
+	ImageResizeHandle(const std::string& path, int maxWidth, int maxHeight);
+
+	void update() override;
+	int getResizeTime() const; // milliseconds spent resizing, without the wait for a worker
+
+private:
+	struct Task;
+
+	std::shared_ptr<Utils::ThreadPool> mPool;
+	std::shared_ptr<Task> mTask;
+};
+
 class ImageDownloadHandle : public AsyncHandle
 {
 public:
@@ -147,6 +172,7 @@ public:
 
 private:
 	std::unique_ptr<HttpReq> mReq;
+	std::unique_ptr<ImageResizeHandle> mResize;
 	std::string mSavePath;
 	int mMaxWidth;
 	int mMaxHeight;
@@ -156,15 +182,16 @@ private:
 //Will create the "downloaded_images" and "subdirectory" directories if they do not exist.
 std::string getSaveAsPath(const ScraperSearchParams& params, const std::string& suffix, const std::string& url);
 
-//Will resize according to Settings::getInt("ScraperResizeWidth") and Settings::getInt("ScraperResizeHeight").
-std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url, const std::string& saveAs);
+//Will resize according to Settings::getInt("ScraperResizeWidth") and Settings::getInt("ScraperResizeHeight"), unless resize is false.
+std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url, const std::string& saveAs, bool resize = true);
 
 // Resolves all metadata assets that need to be downloaded.
-std::unique_ptr<MDResolveHandle> resolveMetaDataAssets(const ScraperSearchResult& result, const ScraperSearchParams& search);
+// Pass resize = false to keep the images as downloaded, to resize them later with resizeImage().
+std::unique_ptr<MDResolveHandle> resolveMetaDataAssets(const ScraperSearchResult& result, const ScraperSearchParams& search, bool resize = true);
 
 //You can pass 0 for maxWidth or maxHeight to automatically keep the aspect ratio.
-//Will overwrite the image at [path] with the new resized one.
-//Returns true if successful, false otherwise.
+//Will overwrite the image at [path] with the new resized one, through a temporary file renamed once complete.
+//Returns true if successful, false otherwise. Can be called from any thread.
 bool resizeImage(const std::string& path, int maxWidth, int maxHeight);
 
 #endif // ES_APP_SCRAPERS_SCRAPER_H
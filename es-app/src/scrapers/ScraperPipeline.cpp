@@ -0,0 +1,214 @@
+#include "scrapers/ScraperPipeline.h"
+
+#include "math/Misc.h"
+#include "FileData.h"
+#include "Log.h"
+#include "Settings.h"
+
+// games past their search, waiting for or in one of the later stages, per allowed request
+static const int JOBS_PER_REQUEST = 4;
+
+// "https://host:port/path?query" -> "host:port"
+static std::string getUrlHost(const std::string& url)
+{
+	size_t start = url.find("://");
+	start = (start == std::string::npos) ? 0 : start + 3;
+
+	const size_t end = url.find_first_of("/?#", start);
+	return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+ScraperPipeline::ScraperPipeline(const std::queue<ScraperSearchParams>& searches) : mPending(searches)
+{
+	for(int i = 0; i < STAGE_COUNT; i++)
+		mStageCounts[i] = 0;
+
+	// a search may take several requests, one after the other, they all go to the scraper's own host
+	// the same host as the media it links to, for ScreenScraper, so searches and downloads share its budget
+	mSearchHost = getUrlHost(getScraperSearchUrl());
+	mMaxRequestsPerHost = Math::max(1, Settings::getInstance()->getInt("ScraperMaxRequestsPerHost"));
+	mRequestInterval = (Uint32)Math::max(0, Settings::getInstance()->getInt("ScraperRequestInterval"));
+	mResizeWidth = Settings::getInstance()->getInt("ScraperResizeWidth");
+	mResizeHeight = Settings::getInstance()->getInt("ScraperResizeHeight");
+}
+
+bool ScraperPipeline::beginRequest(const std::string& host, Uint32 now)
+{
+	auto it = mHosts.find(host);
+	if(it == mHosts.cend())
+	{
+		HostState state = { 0, now - mRequestInterval };
+		it = mHosts.insert(std::make_pair(host, state)).first;
+	}
+
+	HostState& state = it->second;
+	if(state.active >= mMaxRequestsPerHost || (now - state.lastRequestTime) < mRequestInterval)
+		return false;
+
+	state.active++;
+	state.lastRequestTime = now;
+	return true;
+}
+
+void ScraperPipeline::endRequest(const std::string& host)
+{
+	auto it = mHosts.find(host);
+	if(it != mHosts.cend() && it->second.active > 0)
+		it->second.active--;
+}
+
+void ScraperPipeline::setStage(Job* job, Stage stage)
+{
+	const Uint32 now = SDL_GetTicks();
+	job->result.stageTime[job->stage] += now - job->stageStart;
+	job->stageStart = now;
+
+	mStageCounts[job->stage]--;
+	mStageCounts[stage]++;
+	job->stage = stage;
+}
+
+void ScraperPipeline::finishJob(Job* job, bool found, const std::string& error)
+{
+	job->result.found = found;
+	job->result.error = error;
+	setStage(job, DONE);
+}
+
+void ScraperPipeline::update(std::vector<Result>& finished)
+{
+	const Uint32 now = SDL_GetTicks();
+
+	// start new searches while the scraper's host allows it
+	while(!mPending.empty() && (int)mJobs.size() < mMaxRequestsPerHost * JOBS_PER_REQUEST && beginRequest(mSearchHost, now))
+	{
+		Job* job = new Job();
+		job->stage = SEARCHING;
+		job->stageStart = now;
+		job->result.search = mPending.front();
+		job->result.found = false;
+		job->result.resizeTime = 0;
+		for(int i = 0; i < STAGE_COUNT; i++)
+			job->result.stageTime[i] = 0;
+		job->searchHandle = startScraperSearch(job->result.search);
+		mStageCounts[SEARCHING]++;
+
+		mJobs.push_back(std::unique_ptr<Job>(job));
+		mPending.pop();
+	}
+
+	for(auto it = mJobs.begin(); it != mJobs.end(); )
+	{
+		Job* job = it->get();
+		updateJob(job, now);
+
+		if(job->stage == DONE)
+		{
+			mStageCounts[DONE]--;
+			finished.push_back(job->result);
+			it = mJobs.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+void ScraperPipeline::updateJob(Job* job, Uint32 now)
+{
+	if(job->stage == SEARCHING)
+	{
+		const AsyncHandleStatus status = job->searchHandle->status();
+		if(status == ASYNC_IN_PROGRESS)
+			return;
+
+		endRequest(mSearchHost);
+
+		if(status == ASYNC_ERROR)
+		{
+			LOG(LogInfo) << "ScraperPipeline search error for " << job->result.search.game->getPath() << ": " << job->searchHandle->getStatusString();
+			finishJob(job, false, job->searchHandle->getStatusString());
+			job->searchHandle.reset();
+			return;
+		}
+
+		const std::vector<ScraperSearchResult>& results = job->searchHandle->getResults();
+		if(results.empty())
+		{
+			finishJob(job, false);
+			job->searchHandle.reset();
+			return;
+		}
+
+		// same as ScraperSearchComponent::ALWAYS_ACCEPT_FIRST_RESULT
+		job->result.result = results.front();
+		job->searchHandle.reset();
+
+		if(job->result.result.imageUrl.empty())
+		{
+			finishJob(job, true);
+			return;
+		}
+
+		job->host = getUrlHost(job->result.result.imageUrl);
+		setStage(job, DOWNLOAD_WAIT);
+	}
+
+	if(job->stage == DOWNLOAD_WAIT)
+	{
+		if(!beginRequest(job->host, now))
+			return;
+
+		// the image is resized by the next stage, not while downloading
+		job->resolveHandle = resolveMetaDataAssets(job->result.result, job->result.search, false);
+		setStage(job, DOWNLOADING);
+	}
+
+	if(job->stage == DOWNLOADING)
+	{
+		const AsyncHandleStatus status = job->resolveHandle->status();
+		if(status == ASYNC_IN_PROGRESS)
+			return;
+
+		endRequest(job->host);
+
+		if(status == ASYNC_ERROR)
+		{
+			LOG(LogInfo) << "ScraperPipeline download error for " << job->result.search.game->getPath() << ": " << job->resolveHandle->getStatusString();
+			finishJob(job, false, job->resolveHandle->getStatusString());
+			job->resolveHandle.reset();
+			return;
+		}
+
+		job->result.result = job->resolveHandle->getResult();
+		job->resolveHandle.reset();
+
+		const std::string& imagePath = job->result.result.mdl.get("image");
+		if(imagePath.empty() || (mResizeWidth == 0 && mResizeHeight == 0))
+		{
+			finishJob(job, true);
+			return;
+		}
+
+		// ImageResizeHandle resizes on worker threads when there are enough cores
+		job->resizeHandle = std::unique_ptr<ImageResizeHandle>(new ImageResizeHandle(imagePath, mResizeWidth, mResizeHeight));
+		setStage(job, RESIZING);
+	}
+
+	if(job->stage == RESIZING)
+	{
+		const AsyncHandleStatus status = job->resizeHandle->status();
+		if(status == ASYNC_IN_PROGRESS)
+			return;
+
+		job->result.resizeTime = (Uint32)job->resizeHandle->getResizeTime();
+
+		if(status == ASYNC_DONE)
+			finishJob(job, true);
+		else
+			finishJob(job, false, job->resizeHandle->getStatusString());
+
+		job->resizeHandle.reset();
+	}
+}
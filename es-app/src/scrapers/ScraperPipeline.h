@@ -0,0 +1,86 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_SCRAPER_PIPELINE_H
+#define ES_APP_SCRAPERS_SCRAPER_PIPELINE_H
+
+#include "scrapers/Scraper.h"
+#include <list>
+#include <map>
+#include <SDL_timer.h>
+
+// Scrapes a queue of games without user interaction, several of them at once.
+// Every game goes through a search, the download of its assets and the resize of the downloaded image.
+// Searches and downloads are limited per host, see "ScraperMaxRequestsPerHost" and "ScraperRequestInterval",
+// images are resized on worker threads and the finished games are handed back from update(), on the main thread.
+class ScraperPipeline
+{
+public:
+	enum Stage
+	{
+		SEARCHING,
+		DOWNLOAD_WAIT, // the image host has too many requests in flight
+		DOWNLOADING,
+		RESIZING,
+		DONE,
+
+		STAGE_COUNT
+	};
+
+	struct Result
+	{
+		ScraperSearchParams search;
+		ScraperSearchResult result;
+		bool found;        // false when nothing was found or on error
+		std::string error; // not empty on error
+		Uint32 stageTime[STAGE_COUNT]; // milliseconds spent in each stage, 0 for the skipped ones
+		Uint32 resizeTime;             // milliseconds spent resizing, stageTime[RESIZING] also counts the wait for a worker
+	};
+
+	ScraperPipeline(const std::queue<ScraperSearchParams>& searches);
+
+	// advances every game that is in progress, the ones done with all stages are added to finished
+	void update(std::vector<Result>& finished);
+
+	inline bool isDone() const { return mPending.empty() && mJobs.empty(); }
+	inline unsigned int getPendingCount() const { return (unsigned int)mPending.size(); }
+	inline unsigned int getSearchingCount() const { return mStageCounts[SEARCHING]; }
+	inline unsigned int getDownloadingCount() const { return mStageCounts[DOWNLOAD_WAIT] + mStageCounts[DOWNLOADING]; }
+	inline unsigned int getResizingCount() const { return mStageCounts[RESIZING]; }
+
+private:
+	struct Job
+	{
+		Stage stage;
+		Uint32 stageStart;
+		Result result;
+		std::string host;
+		std::unique_ptr<ScraperSearchHandle> searchHandle;
+		std::unique_ptr<MDResolveHandle> resolveHandle;
+		std::unique_ptr<ImageResizeHandle> resizeHandle;
+	};
+
+	struct HostState
+	{
+		int active;
+		Uint32 lastRequestTime;
+	};
+
+	bool beginRequest(const std::string& host, Uint32 now);
+	void endRequest(const std::string& host);
+
+	void setStage(Job* job, Stage stage);
+	void updateJob(Job* job, Uint32 now);
+	void finishJob(Job* job, bool found, const std::string& error = "");
+
+	std::queue<ScraperSearchParams> mPending;
+	std::list< std::unique_ptr<Job> > mJobs;
+	unsigned int mStageCounts[STAGE_COUNT];
+
+	std::map<std::string, HostState> mHosts;
+	std::string mSearchHost;
+	int mMaxRequestsPerHost;
+	Uint32 mRequestInterval;
+	int mResizeWidth;
+	int mResizeHeight;
+};
+
+#endif // ES_APP_SCRAPERS_SCRAPER_PIPELINE_H
@@ -366,15 +366,15 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 
 	if (selectedViewType == AUTOMATIC)
 	{
-		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
-		for (auto it = files.cbegin(); it != files.cend(); it++)
+		FileData::FileIterator files(system->getRootFolder(), GAME | FOLDER);
+		while (FileData* file = files.next())
 		{
-			if (themeHasVideoView && !(*it)->getVideoPath().empty())
+			if (themeHasVideoView && !file->getVideoPath().empty())
 			{
 				selectedViewType = VIDEO;
 				break;
 			}
-			else if (!(*it)->getThumbnailPath().empty())
+			else if (!file->getThumbnailPath().empty())
 			{
 				selectedViewType = DETAILED;
 				// Don't break out in case any subsequent files have video
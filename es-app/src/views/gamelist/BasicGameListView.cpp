@@ -6,6 +6,7 @@
 #include "CollectionSystemManager.h"
 #include "Settings.h"
 #include "SystemData.h"
+#include <string.h>
 
 BasicGameListView::BasicGameListView(Window* window, FileData* root)
 	: ISimpleGameListView(window, root), mList(window)
@@ -36,6 +37,13 @@ void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
 		return;
 	}
 
+	// a game with media might switch to a detailed view too
+	if(change == FILE_ADDED && strcmp(getName(), "basic") == 0 && (!file->getThumbnailPath().empty() || !file->getVideoPath().empty()))
+	{
+		ViewController::get()->reloadGameListView(this);
+		return;
+	}
+
 	ISimpleGameListView::onFileChanged(file, change);
 }
 
@@ -56,6 +64,16 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 	}
 }
 
+void BasicGameListView::insertEntry(FileData* file, int index)
+{
+	mList.insert(file->getName(), file, (file->getType() == FOLDER), index);
+}
+
+void BasicGameListView::removeEntry(FileData* file)
+{
+	mList.remove(file);
+}
+
 FileData* BasicGameListView::getCursor()
 {
 	return mList.getSelected();
@@ -228,7 +228,7 @@ void DetailedGameListView::updateInfoPanel()
 		mDescContainer.reset();
 
 		mRating.setValue(file->metadata.get("rating"));
-		mReleaseDate.setValue(file->metadata.get("releasedate"));
+		mReleaseDate.setTime(file->metadata.getTime("releasedate"));
 		mDeveloper.setValue(file->metadata.get("developer"));
 		mPublisher.setValue(file->metadata.get("publisher"));
 		mGenre.setValue(file->metadata.get("genre"));
@@ -237,7 +237,7 @@ void DetailedGameListView::updateInfoPanel()
 
 		if(file->getType() == GAME)
 		{
-			mLastPlayed.setValue(file->metadata.get("lastplayed"));
+			mLastPlayed.setTime(file->metadata.getTime("lastplayed"));
 			mPlayCount.setValue(file->metadata.get("playcount"));
 		}
 
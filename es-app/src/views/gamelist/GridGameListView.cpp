@@ -187,6 +187,16 @@ void GridGameListView::populateList(const std::vector<FileData*>& files)
 	}
 }
 
+void GridGameListView::insertEntry(FileData* file, int index)
+{
+	mGrid.insert(file->getName(), getImagePath(file), file, index);
+}
+
+void GridGameListView::removeEntry(FileData* file)
+{
+	mGrid.remove(file);
+}
+
 void GridGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
 {
 	ISimpleGameListView::onThemeChanged(theme);
@@ -331,7 +341,7 @@ void GridGameListView::updateInfoPanel()
 		mDescContainer.reset();
 
 		mRating.setValue(file->metadata.get("rating"));
-		mReleaseDate.setValue(file->metadata.get("releasedate"));
+		mReleaseDate.setTime(file->metadata.getTime("releasedate"));
 		mDeveloper.setValue(file->metadata.get("developer"));
 		mPublisher.setValue(file->metadata.get("publisher"));
 		mGenre.setValue(file->metadata.get("genre"));
@@ -340,7 +350,7 @@ void GridGameListView::updateInfoPanel()
 
 		if(file->getType() == GAME)
 		{
-			mLastPlayed.setValue(file->metadata.get("lastplayed"));
+			mLastPlayed.setTime(file->metadata.getTime("lastplayed"));
 			mPlayCount.setValue(file->metadata.get("playcount"));
 		}
 
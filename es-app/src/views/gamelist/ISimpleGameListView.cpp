@@ -7,6 +7,7 @@
 #include "Settings.h"
 #include "Sound.h"
 #include "SystemData.h"
+#include <algorithm>
 
 ISimpleGameListView::ISimpleGameListView(Window* window, FileData* root) : IGameListView(window, root),
 	mHeaderText(window), mHeaderImage(window), mBackground(window)
@@ -61,8 +62,12 @@ void ISimpleGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme
 	}
 }
 
-void ISimpleGameListView::onFileChanged(FileData* /*file*/, FileChangeType /*change*/)
+void ISimpleGameListView::onFileChanged(FileData* file, FileChangeType change)
 {
+	// a single game was added or moved, only its own entry needs to be updated
+	if(change == FILE_ADDED && file->getType() == GAME && updateEntry(file))
+		return;
+
 	// we could be tricky here to be efficient;
 	// but this shouldn't happen very often so we'll just always repopulate
 	FileData* cursor = getCursor();
@@ -77,6 +82,36 @@ void ISimpleGameListView::onFileChanged(FileData* /*file*/, FileChangeType /*cha
 	}
 }
 
+// returns false when the whole list has to be repopulated instead
+bool ISimpleGameListView::updateEntry(FileData* file)
+{
+	FileData* cursor = getCursor();
+	FileData* parent = file->getParent();
+	if(cursor->isPlaceHolder() || !parent)
+		return false;
+
+	// entries of other folders are picked up when that folder is opened
+	if(parent != cursor->getParent())
+		return true;
+
+	// the list holds every displayed child except the file itself in the same order, so its position carries over
+	const std::vector<FileData*>& files = parent->getChildrenListToDisplay();
+	auto it = std::find(files.cbegin(), files.cend(), file);
+
+	// the cursor would have nowhere to go
+	if(cursor == file && it == files.cend())
+		return false;
+
+	removeEntry(file);
+	if(it != files.cend())
+		insertEntry(file, (int)(it - files.cbegin()));
+
+	if(cursor == file)
+		setCursor(file);
+
+	return true;
+}
+
 bool ISimpleGameListView::input(InputConfig* config, Input input)
 {
 	if(input.value != 0)
@@ -17,6 +17,7 @@ public:
 	// Called when a new file is added, a file is removed, a file's metadata changes, or a file's children are sorted.
 	// NOTE: FILE_SORTED is only reported for the topmost FileData, where the sort started.
 	//       Since sorts are recursive, that FileData's children probably changed too.
+	//       FILE_ADDED for a game expects it to already be at its sorted position in its parent, only its own entry is updated.
 	virtual void onFileChanged(FileData* file, FileChangeType change) override;
 
 	// Called whenever the theme changes.
@@ -36,6 +37,10 @@ protected:
 	virtual std::string getQuickSystemSelectRightButton() = 0;
 	virtual std::string getQuickSystemSelectLeftButton() = 0;
 	virtual void populateList(const std::vector<FileData*>& files) = 0;
+	virtual void insertEntry(FileData* file, int index) = 0;
+	virtual void removeEntry(FileData* file) = 0;
+
+	bool updateEntry(FileData* file);
 
 	TextComponent mHeaderText;
 	ImageComponent mHeaderImage;
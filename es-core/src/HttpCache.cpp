@@ -0,0 +1,350 @@
+#include "HttpCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include "Settings.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <vector>
+
+// query parameters identifying the user rather than what is requested
+static const char* CREDENTIAL_PARAMETERS[] = { "apikey", "devid", "devpassword", "ssid", "sspassword", "password", "token" };
+
+// 64 bit FNV-1a, unlike std::hash it is the same from one run to the next
+static unsigned long long hashString(const std::string& _string)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	for(const char c : _string)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+static long long getFileSize(const std::string& _path, time_t* _modified = nullptr)
+{
+	struct stat info;
+	if(stat(_path.c_str(), &info) != 0)
+		return -1;
+
+	if(_modified)
+		*_modified = info.st_mtime;
+
+	return (long long)info.st_size;
+}
+
+// an entry's file is written next to it and renamed over it, so it is never left half written
+static bool replaceFile(const std::string& _temporary, const std::string& _path)
+{
+#if defined(_WIN32)
+	// rename() doesn't replace an existing file there
+	std::remove(_path.c_str());
+#endif
+	if(std::rename(_temporary.c_str(), _path.c_str()) != 0)
+	{
+		std::remove(_temporary.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static bool copyFile(const std::string& _from, const std::string& _to)
+{
+	std::ifstream in(_from, std::ios::binary);
+	if(!in.good())
+		return false;
+
+	std::ofstream out(_to, std::ios::binary | std::ios::trunc);
+	out << in.rdbuf();
+	out.close();
+
+	return !out.fail();
+}
+
+HttpCache* HttpCache::get()
+{
+	static HttpCache cache;
+	return Settings::getInstance()->getBool("HttpCache") ? &cache : nullptr;
+}
+
+HttpCache::HttpCache() : mSize(-1)
+{
+	mDirectory = Utils::FileSystem::getGenericPath(Utils::FileSystem::getHomePath() + "/configs/emulationstation/http_cache");
+	mDefaultTTL = (time_t)Settings::getInstance()->getInt("HttpCacheTTL");
+	mMaxSize = (long long)Settings::getInstance()->getInt("HttpCacheMaxSize") * 1024 * 1024;
+
+	Utils::FileSystem::createDirectory(mDirectory);
+}
+
+std::string HttpCache::normalizeUrl(const std::string& url)
+{
+	std::string result = url.substr(0, url.find('#'));
+
+	const size_t schemeEnd = result.find("://");
+	const size_t hostStart = (schemeEnd == std::string::npos) ? 0 : schemeEnd + 3;
+	size_t pathStart = result.find_first_of("/?", hostStart);
+	if(pathStart == std::string::npos)
+		pathStart = result.size();
+
+	// "user:password@host" -> "host"
+	std::string host = result.substr(hostStart, pathStart - hostStart);
+	const size_t userEnd = host.rfind('@');
+	if(userEnd != std::string::npos)
+		host.erase(0, userEnd + 1);
+
+	const size_t queryStart = result.find('?', pathStart);
+	std::string normalized = Utils::String::toLower(result.substr(0, hostStart) + host) +
+		result.substr(pathStart, queryStart == std::string::npos ? std::string::npos : queryStart - pathStart);
+
+	if(queryStart != std::string::npos)
+	{
+		std::vector<std::string> parameters;
+		const std::vector<std::string> query = Utils::String::delimitedStringToVector(result.substr(queryStart + 1), "&");
+
+		for(auto it = query.cbegin(); it != query.cend(); it++)
+		{
+			const std::string name = Utils::String::toLower(it->substr(0, it->find('=')));
+			bool credential = false;
+
+			for(const char* parameter : CREDENTIAL_PARAMETERS)
+				credential |= (name == parameter);
+
+			if(!credential && !it->empty())
+				parameters.push_back(*it);
+		}
+
+		std::sort(parameters.begin(), parameters.end());
+
+		if(!parameters.empty())
+			normalized += "?" + Utils::String::vectorToDelimitedString(parameters, "&");
+	}
+
+	return normalized;
+}
+
+std::string HttpCache::getEntryPath(const std::string& url)
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", hashString(normalizeUrl(url)));
+
+	return mDirectory + "/" + name;
+}
+
+// the header file holds the normalized url, to catch hash collisions, the expiry date, ETag and Last-Modified
+bool HttpCache::find(const std::string& url, Entry& entry)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	std::ifstream header(getEntryPath(url) + ".header");
+	if(!header.good())
+		return false;
+
+	std::string entryUrl;
+	std::string expires;
+	if(!std::getline(header, entryUrl) || entryUrl != normalizeUrl(url) || !std::getline(header, expires))
+		return false;
+
+	entry.expires = (time_t)atoll(expires.c_str());
+	std::getline(header, entry.etag);
+	std::getline(header, entry.lastModified);
+
+	return true;
+}
+
+bool HttpCache::read(const std::string& url, std::string& content)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	std::ifstream body(getEntryPath(url) + ".body", std::ios::binary);
+	if(!body.good())
+		return false;
+
+	content.assign(std::istreambuf_iterator<char>(body), std::istreambuf_iterator<char>());
+	return !body.bad();
+}
+
+bool HttpCache::readToFile(const std::string& url, const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// like an entry, the file is copied next to it and renamed over it so a failed copy doesn't lose what was there
+	if(!copyFile(getEntryPath(url) + ".body", path + ".tmp"))
+	{
+		std::remove((path + ".tmp").c_str());
+		return false;
+	}
+
+	return replaceFile(path + ".tmp", path);
+}
+
+bool HttpCache::writeHeader(const std::string& path, const std::string& url, const Entry& entry)
+{
+	std::ofstream header(path + ".header.tmp", std::ios::trunc);
+	header << normalizeUrl(url) << "\n" << (long long)entry.expires << "\n" << entry.etag << "\n" << entry.lastModified << "\n";
+	header.close();
+
+	if(header.fail())
+	{
+		std::remove((path + ".header.tmp").c_str());
+		return false;
+	}
+
+	return replaceFile(path + ".header.tmp", path + ".header");
+}
+
+// the old header is removed first, an interrupted write leaves no entry rather than an old header with another body
+bool HttpCache::writeBody(const std::string& path, const std::string& content)
+{
+	std::remove((path + ".header").c_str());
+
+	std::ofstream body(path + ".body.tmp", std::ios::binary | std::ios::trunc);
+	body.write(content.data(), content.size());
+	body.close();
+
+	if(body.fail())
+	{
+		std::remove((path + ".body.tmp").c_str());
+		return false;
+	}
+
+	return replaceFile(path + ".body.tmp", path + ".body");
+}
+
+bool HttpCache::writeBodyFromFile(const std::string& path, const std::string& file)
+{
+	std::remove((path + ".header").c_str());
+
+	if(!copyFile(file, path + ".body.tmp"))
+	{
+		std::remove((path + ".body.tmp").c_str());
+		return false;
+	}
+
+	return replaceFile(path + ".body.tmp", path + ".body");
+}
+
+void HttpCache::write(const std::string& url, const Entry& entry, const std::string& content)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	const std::string path     = getEntryPath(url);
+	const long long   previous = std::max(0LL, getFileSize(path + ".body"));
+	if(!writeBody(path, content) || !writeHeader(path, url, entry))
+	{
+		LOG(LogWarning) << "HttpCache: failed to write " << path;
+		std::remove((path + ".header").c_str());
+	}
+
+	// a rewritten entry only adds the difference, a failed write may have replaced the body all the same
+	addSize(std::max(0LL, getFileSize(path + ".body")) - previous);
+}
+
+void HttpCache::writeFromFile(const std::string& url, const Entry& entry, const std::string& file)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	const std::string path     = getEntryPath(url);
+	const long long   previous = std::max(0LL, getFileSize(path + ".body"));
+	if(!writeBodyFromFile(path, file) || !writeHeader(path, url, entry))
+	{
+		LOG(LogWarning) << "HttpCache: failed to write " << path;
+		std::remove((path + ".header").c_str());
+	}
+
+	addSize(std::max(0LL, getFileSize(path + ".body")) - previous);
+}
+
+void HttpCache::refresh(const std::string& url, const Entry& entry)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	writeHeader(getEntryPath(url), url, entry);
+}
+
+void HttpCache::expire(const std::string& url)
+{
+	Entry entry;
+	if(!find(url, entry))
+		return;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	entry.expires = 0;
+	writeHeader(getEntryPath(url), url, entry);
+}
+
+// size is how much the entry that was written grew, negative when it shrank
+void HttpCache::addSize(long long size)
+{
+	// the size of what was cached by previous runs is only needed once something is added
+	if(mSize < 0)
+	{
+		mSize = 0;
+
+		const Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(mDirectory);
+		for(auto it = files.cbegin(); it != files.cend(); it++)
+		{
+			const std::string extension = Utils::FileSystem::getExtension(*it);
+			if(extension == ".body")
+				mSize += std::max(0LL, getFileSize(*it));
+			else if(extension == ".tmp")
+				std::remove(it->c_str()); // left by an interrupted write
+		}
+	}
+	else
+	{
+		mSize = std::max(0LL, mSize + size);
+	}
+
+	if(mSize > mMaxSize)
+		trim();
+}
+
+// removes the least recently written entries until the cache is back under 90% of its limit
+// entries are removed with std::remove(), Utils::FileSystem::removeFile() trusts the memoized exists()
+void HttpCache::trim()
+{
+	struct CachedBody
+	{
+		time_t modified;
+		long long size;
+		std::string path;
+	};
+
+	// the listing is the actual size on disk, whatever mSize counted so far
+	std::vector<CachedBody> bodies;
+	mSize = 0;
+	const Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(mDirectory);
+	for(auto it = files.cbegin(); it != files.cend(); it++)
+	{
+		if(Utils::FileSystem::getExtension(*it) != ".body")
+			continue;
+
+		CachedBody body;
+		body.size = getFileSize(*it, &body.modified);
+		body.path = it->substr(0, it->size() - 5);
+		if(body.size >= 0)
+		{
+			bodies.push_back(body);
+			mSize += body.size;
+		}
+	}
+
+	std::sort(bodies.begin(), bodies.end(), [](const CachedBody& a, const CachedBody& b) { return a.modified < b.modified; });
+
+	for(auto it = bodies.cbegin(); it != bodies.cend() && mSize > mMaxSize * 9 / 10; it++)
+	{
+		std::remove((it->path + ".header").c_str());
+		std::remove((it->path + ".body").c_str());
+		mSize -= it->size;
+	}
+
+	LOG(LogInfo) << "HttpCache: trimmed to " << (mSize / 1024) << " KB";
+}
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef ES_CORE_HTTP_CACHE_H
+#define ES_CORE_HTTP_CACHE_H
+
+#include <mutex>
+#include <string>
+#include <time.h>
+
+// Persistent cache of HTTP responses, in "[home]/configs/emulationstation/http_cache".
+// Entries are keyed by the normalized url without credentials, so api keys and passwords never end up in it.
+// A fresh entry is used without any request, an expired one is revalidated with its ETag or Last-Modified date.
+// Once the cache grows past "HttpCacheMaxSize" megabytes the oldest entries are removed.
+// Every method can be used from any thread.
+class HttpCache
+{
+public:
+	struct Entry
+	{
+		time_t expires;
+		std::string etag;
+		std::string lastModified;
+	};
+
+	static HttpCache* get(); // NULL when "HttpCache" is off
+
+	bool find(const std::string& url, Entry& entry);
+	bool read(const std::string& url, std::string& content);
+	bool readToFile(const std::string& url, const std::string& path);
+
+	void write(const std::string& url, const Entry& entry, const std::string& content);
+	void writeFromFile(const std::string& url, const Entry& entry, const std::string& path);
+	void refresh(const std::string& url, const Entry& entry); // the server confirmed the content didn't change
+	void expire(const std::string& url); // the next request revalidates the entry instead of using it as is
+
+	inline time_t getDefaultTTL() const { return mDefaultTTL; }
+
+	// lower case scheme and host, no user info or fragment, credentials removed from the query and the remaining parameters sorted
+	static std::string normalizeUrl(const std::string& url);
+
+private:
+	HttpCache();
+
+	std::string getEntryPath(const std::string& url);
+	bool writeHeader(const std::string& path, const std::string& url, const Entry& entry);
+	bool writeBody(const std::string& path, const std::string& content);
+	bool writeBodyFromFile(const std::string& path, const std::string& file);
+	void addSize(long long size);
+	void trim();
+
+	std::mutex mMutex;
+	std::string mDirectory;
+	time_t mDefaultTTL;
+	long long mMaxSize;
+	long long mSize; // -1 until the directory was looked at
+};
+
+#endif // ES_CORE_HTTP_CACHE_H
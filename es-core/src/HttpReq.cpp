@@ -1,12 +1,198 @@
 #include "HttpReq.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
 #include "Log.h"
+#include <algorithm>
 #include <assert.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// owns the curl multi handle, only its thread ever uses it
+// connections are kept alive in the multi handle between requests and shared by HTTP/2 requests to the same host
+// it is never destroyed, requests held by static objects are still removed from it after main() returned
+class HttpReq::Network
+{
+public:
+	static Network& get()
+	{
+		static Network* network = new Network();
+		return *network;
+	}
+
+	void add(HttpReq* req);
+	void remove(HttpReq* req); // returns once the network thread doesn't use req anymore
+	void wait(HttpReq* req); // returns right away once shut down
+	void shutdown();
+
+private:
+	Network();
+
+	void run();
+	void wakeup();
 
-CURLM* HttpReq::s_multi_handle = curl_multi_init();
+	CURLM* mMultiHandle;
+	std::thread mThread;
+	std::atomic<bool> mRunning;
 
-std::map<CURL*, HttpReq*> HttpReq::s_requests;
+	std::mutex mMutex;
+	std::condition_variable mChanged; // a request was removed or is done
+	std::vector<HttpReq*> mAdded;
+	std::vector<HttpReq*> mRemoved;
+};
+
+HttpReq::Network::Network() : mRunning(true)
+{
+	mMultiHandle = curl_multi_init();
+	curl_multi_setopt(mMultiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	mThread = std::thread(&Network::run, this);
+}
+
+void HttpReq::Network::shutdown()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if(!mRunning)
+			return;
+
+		mRunning = false;
+	}
+
+	wakeup();
+	mThread.join();
+
+	// removals the thread didn't get to, the multi handle is only used under the lock from now on
+	std::unique_lock<std::mutex> lock(mMutex);
+	for(auto it = mRemoved.cbegin(); it != mRemoved.cend(); it++)
+		curl_multi_remove_handle(mMultiHandle, (*it)->mHandle);
+	mRemoved.clear();
+	mAdded.clear();
+
+	mChanged.notify_all();
+}
+
+void HttpReq::Network::wakeup()
+{
+#if CURL_AT_LEAST_VERSION(7,68,0)
+	curl_multi_wakeup(mMultiHandle);
+#endif
+}
+
+void HttpReq::Network::add(HttpReq* req)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mAdded.push_back(req);
+	wakeup();
+}
+
+void HttpReq::Network::remove(HttpReq* req)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// done requests were already removed from the multi handle
+	if(req->mStatus != REQ_IN_PROGRESS)
+		return;
+
+	for(auto it = mAdded.begin(); it != mAdded.end(); it++)
+	{
+		if(*it == req)
+		{
+			mAdded.erase(it);
+			return;
+		}
+	}
+
+	// nothing would remove it anymore
+	if(!mRunning)
+	{
+		curl_multi_remove_handle(mMultiHandle, req->mHandle);
+		return;
+	}
+
+	mRemoved.push_back(req);
+	wakeup();
+
+	mChanged.wait(lock, [this, req] { return std::find(mRemoved.cbegin(), mRemoved.cend(), req) == mRemoved.cend(); });
+}
+
+void HttpReq::Network::wait(HttpReq* req)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mChanged.wait(lock, [this, req] { return req->mStatus != REQ_IN_PROGRESS || !mRunning; });
+}
+
+void HttpReq::Network::run()
+{
+	while(mRunning)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			bool changed = !mRemoved.empty();
+
+			for(auto it = mRemoved.cbegin(); it != mRemoved.cend(); it++)
+			{
+				CURLMcode merr = curl_multi_remove_handle(mMultiHandle, (*it)->mHandle);
+				if(merr != CURLM_OK)
+					LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
+			}
+			mRemoved.clear();
+
+			for(auto it = mAdded.cbegin(); it != mAdded.cend(); it++)
+			{
+				CURLMcode merr = curl_multi_add_handle(mMultiHandle, (*it)->mHandle);
+				if(merr != CURLM_OK)
+				{
+					(*it)->onError(curl_multi_strerror(merr));
+					(*it)->mStatus = REQ_IO_ERROR;
+					changed = true;
+				}
+			}
+			mAdded.clear();
+
+			int handle_count;
+			CURLMcode merr = curl_multi_perform(mMultiHandle, &handle_count);
+			if(merr != CURLM_OK && merr != CURLM_CALL_MULTI_PERFORM)
+				LOG(LogError) << "Error performing curl_multi transfers: " << curl_multi_strerror(merr);
+
+			int msgs_left;
+			CURLMsg* msg;
+			while((msg = curl_multi_info_read(mMultiHandle, &msgs_left)) != nullptr)
+			{
+				if(msg->msg != CURLMSG_DONE)
+					continue;
+
+				// msg is freed along with the handle
+				CURL* handle = msg->easy_handle;
+				CURLcode result = msg->data.result;
+
+				char* req = NULL;
+				curl_easy_getinfo(handle, CURLINFO_PRIVATE, &req);
+				curl_multi_remove_handle(mMultiHandle, handle);
+
+				if(req == NULL)
+				{
+					LOG(LogError) << "Cannot find easy handle!";
+					continue;
+				}
+
+				((HttpReq*)req)->onDone(result);
+				changed = true;
+			}
+
+			if(changed)
+				mChanged.notify_all();
+		}
+
+		// sleeps until there is something to read or write, or add() and remove() wake it up
+#if CURL_AT_LEAST_VERSION(7,68,0)
+		curl_multi_poll(mMultiHandle, NULL, 0, 1000, NULL);
+#else
+		curl_multi_wait(mMultiHandle, NULL, 0, 10, NULL);
+#endif
+	}
+}
 
 std::string HttpReq::urlEncode(const std::string &s)
 {
@@ -38,8 +224,51 @@ bool HttpReq::isUrl(const std::string& str)
 }
 
 HttpReq::HttpReq(const std::string& url)
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mHeaders(NULL), mFile(NULL)
+{
+	init(url);
+}
+
+HttpReq::HttpReq(const std::string& url, const std::string& saveAs)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mHeaders(NULL), mSavePath(saveAs), mFile(NULL)
+{
+	init(url);
+}
+
+void HttpReq::init(const std::string& url)
 {
+	mUrl = url;
+	mCache = HttpCache::get();
+	mRevalidating = false;
+	mMaxAge = -1;
+	mNoStore = false;
+
+	if(mCache && mCache->find(url, mCacheEntry))
+	{
+		//still fresh, no need to ask the server
+		if(mCacheEntry.expires > time(NULL) && loadFromCache())
+		{
+			if(!mSavePath.empty())
+				Utils::FileSystem::invalidateExists(mSavePath);
+			mStatus = REQ_SUCCESS;
+			return;
+		}
+
+		mRevalidating = !mCacheEntry.etag.empty() || !mCacheEntry.lastModified.empty();
+	}
+
+	//downloaded next to the file and renamed over it once done, a failed download leaves the old file alone
+	if(!mSavePath.empty())
+	{
+		mFile = fopen((mSavePath + ".part").c_str(), "wb");
+		if(mFile == NULL)
+		{
+			mStatus = REQ_IO_ERROR;
+			onError("Failed to open file to write, permission error?");
+			return;
+		}
+	}
+
 	mHandle = curl_easy_init();
 
 	if(mHandle == NULL)
@@ -109,72 +338,158 @@ HttpReq::HttpReq(const std::string& url)
 		return;
 	}
 
-	//add the handle to our multi
-	CURLMcode merr = curl_multi_add_handle(s_multi_handle, mHandle);
-	if(merr != CURLM_OK)
+	//and find this HttpReq again once the network thread is done with the handle
+	err = curl_easy_setopt(mHandle, CURLOPT_PRIVATE, this);
+	if(err != CURLE_OK)
 	{
 		mStatus = REQ_IO_ERROR;
-		onError(curl_multi_strerror(merr));
+		onError(curl_easy_strerror(err));
 		return;
 	}
 
-	s_requests[mHandle] = this;
+	//read the caching headers of the response
+	if(mCache)
+	{
+		err = curl_easy_setopt(mHandle, CURLOPT_HEADERFUNCTION, &HttpReq::write_header);
+		if(err == CURLE_OK)
+			err = curl_easy_setopt(mHandle, CURLOPT_HEADERDATA, this);
+		if(err != CURLE_OK)
+		{
+			mStatus = REQ_IO_ERROR;
+			onError(curl_easy_strerror(err));
+			return;
+		}
+	}
+
+	//the server answers 304 if our expired copy is still valid
+	if(mRevalidating)
+	{
+		if(!mCacheEntry.etag.empty())
+			mHeaders = curl_slist_append(mHeaders, ("If-None-Match: " + mCacheEntry.etag).c_str());
+		if(!mCacheEntry.lastModified.empty())
+			mHeaders = curl_slist_append(mHeaders, ("If-Modified-Since: " + mCacheEntry.lastModified).c_str());
+
+		err = curl_easy_setopt(mHandle, CURLOPT_HTTPHEADER, mHeaders);
+		if(err != CURLE_OK)
+		{
+			mStatus = REQ_IO_ERROR;
+			onError(curl_easy_strerror(err));
+			return;
+		}
+	}
+
+	//keep connections alive and prefer HTTP/2, so bursts of requests to the same host share a connection
+	//none of these are required, curl may not be built with HTTP/2 support
+	curl_easy_setopt(mHandle, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(mHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+	curl_easy_setopt(mHandle, CURLOPT_PIPEWAIT, 1L);
+
+	//the network thread adds the handle to its multi handle
+	Network::get().add(this);
 }
 
 HttpReq::~HttpReq()
 {
 	if(mHandle)
 	{
-		s_requests.erase(mHandle);
-
-		CURLMcode merr = curl_multi_remove_handle(s_multi_handle, mHandle);
+		Network::get().remove(this);
+		curl_easy_cleanup(mHandle);
+	}
 
-		if(merr != CURLM_OK)
-			LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
+	curl_slist_free_all(mHeaders);
 
-		curl_easy_cleanup(mHandle);
+	//cancelled while downloading
+	if(mFile)
+	{
+		fclose(mFile);
+		std::remove((mSavePath + ".part").c_str());
 	}
 }
 
-HttpReq::Status HttpReq::status()
+void HttpReq::shutdown()
+{
+	Network::get().shutdown();
+}
+
+HttpReq::Status HttpReq::wait()
 {
 	if(mStatus == REQ_IN_PROGRESS)
+		Network::get().wait(this);
+
+	return mStatus;
+}
+
+bool HttpReq::loadFromCache()
+{
+	if(mSavePath.empty())
 	{
-		int handle_count;
-		CURLMcode merr = curl_multi_perform(s_multi_handle, &handle_count);
-		if(merr != CURLM_OK && merr != CURLM_CALL_MULTI_PERFORM)
-		{
-			mStatus = REQ_IO_ERROR;
-			onError(curl_multi_strerror(merr));
-			return mStatus;
-		}
+		std::string content;
+		if(!mCache->read(mUrl, content))
+			return false;
 
-		int msgs_left;
-		CURLMsg* msg;
-		while((msg = curl_multi_info_read(s_multi_handle, &msgs_left)) != nullptr)
-		{
-			if(msg->msg == CURLMSG_DONE)
-			{
-				HttpReq* req = s_requests[msg->easy_handle];
+		mContent.str(content);
+		return true;
+	}
 
-				if(req == NULL)
-				{
-					LOG(LogError) << "Cannot find easy handle!";
-					continue;
-				}
+	return mCache->readToFile(mUrl, mSavePath);
+}
 
-				if(msg->data.result == CURLE_OK)
-				{
-					req->mStatus = REQ_SUCCESS;
-				}else{
-					req->mStatus = REQ_IO_ERROR;
-					req->onError(curl_easy_strerror(msg->data.result));
-				}
-			}
+void HttpReq::onDone(CURLcode result)
+{
+	if(mFile)
+	{
+		if(fclose(mFile) != 0 && result == CURLE_OK)
+			result = CURLE_WRITE_ERROR;
+		mFile = NULL;
+	}
+
+	long code = 0;
+	curl_easy_getinfo(mHandle, CURLINFO_RESPONSE_CODE, &code);
+	const time_t expires = time(NULL) + (mMaxAge >= 0 ? (time_t)mMaxAge : (mCache ? mCache->getDefaultTTL() : 0));
+
+	std::string error;
+	if(result != CURLE_OK)
+	{
+		error = curl_easy_strerror(result);
+	}
+	else if(mRevalidating && code == 304)
+	{
+		mCacheEntry.expires = expires;
+		if(loadFromCache())
+			mCache->refresh(mUrl, mCacheEntry);
+		else
+			error = "Cached response disappeared";
+	}
+	else
+	{
+		if(mCache && !mNoStore && code >= 200 && code < 300)
+		{
+			HttpCache::Entry entry = { expires, mEtag, mLastModified };
+			if(mSavePath.empty())
+				mCache->write(mUrl, entry, mContent.str());
+			else
+				mCache->writeFromFile(mUrl, entry, mSavePath + ".part");
 		}
+
+		if(!mSavePath.empty() && !Utils::FileSystem::renameFile(mSavePath + ".part", mSavePath))
+			error = "Failed to replace file, permission error?";
 	}
 
-	return mStatus;
+	//the download is left over when it failed or the cached copy was used, whatever was saved before stays
+	if(!mSavePath.empty())
+	{
+		std::remove((mSavePath + ".part").c_str());
+		Utils::FileSystem::invalidateExists(mSavePath);
+	}
+
+	//the status is set last, other threads may use the request as soon as it is done
+	if(error.empty())
+	{
+		mStatus = REQ_SUCCESS;
+	}else{
+		onError(error.c_str());
+		mStatus = REQ_IO_ERROR;
+	}
 }
 
 std::string HttpReq::getContent() const
@@ -198,12 +513,62 @@ std::string HttpReq::getErrorMsg()
 //return value is number of elements successfully read
 size_t HttpReq::write_content(void* buff, size_t size, size_t nmemb, void* req_ptr)
 {
-	std::stringstream& ss = ((HttpReq*)req_ptr)->mContent;
-	ss.write((char*)buff, size * nmemb);
+	HttpReq* req = (HttpReq*)req_ptr;
+
+	//straight to disk, a short write makes curl fail the transfer
+	if(req->mFile)
+		return fwrite(buff, size, nmemb, req->mFile);
+
+	req->mContent.write((char*)buff, size * nmemb);
 
 	return nmemb;
 }
 
+//used as a curl callback, once per header line
+size_t HttpReq::write_header(char* buff, size_t size, size_t nitems, void* req_ptr)
+{
+	HttpReq* req = (HttpReq*)req_ptr;
+	const std::string line = Utils::String::trim(std::string(buff, size * nitems));
+	const size_t colon = line.find(':');
+
+	if(line.compare(0, 5, "HTTP/") == 0)
+	{
+		//every redirect starts a new response
+		req->mEtag.clear();
+		req->mLastModified.clear();
+		req->mMaxAge = -1;
+		req->mNoStore = false;
+	}
+	else if(colon != std::string::npos)
+	{
+		const std::string name = Utils::String::toLower(line.substr(0, colon));
+		const std::string value = Utils::String::trim(line.substr(colon + 1));
+
+		if(name == "etag")
+		{
+			req->mEtag = value;
+		}
+		else if(name == "last-modified")
+		{
+			req->mLastModified = value;
+		}
+		else if(name == "cache-control")
+		{
+			const std::string directives = Utils::String::toLower(value);
+			const size_t maxAge = directives.find("max-age=");
+
+			if(directives.find("no-store") != std::string::npos)
+				req->mNoStore = true;
+			else if(directives.find("no-cache") != std::string::npos)
+				req->mMaxAge = 0;
+			else if(maxAge != std::string::npos)
+				req->mMaxAge = atol(directives.c_str() + maxAge + 8);
+		}
+	}
+
+	return size * nitems;
+}
+
 //used as a curl callback
 /*int HttpReq::update_progress(void* req_ptr, double dlTotal, double dlNow, double ulTotal, double ulNow)
 {
@@ -2,9 +2,11 @@
 #ifndef ES_CORE_HTTP_REQ_H
 #define ES_CORE_HTTP_REQ_H
 
+#include "HttpCache.h"
 #include <curl/curl.h>
-#include <map>
+#include <atomic>
 #include <sstream>
+#include <stdio.h>
 
 /* Usage:
  * HttpReq myRequest("www.google.com", "/index.html");
@@ -21,12 +23,17 @@
  *
  * std::string content = myRequest.getContent();
  * //process contents...
+ *
+ * //requests are run by a network thread, status() never blocks and wait() blocks until the request is done
+ * //HttpReq myRequest("www.google.com/logo.png", "/tmp/logo.png") writes the response to a file instead of memory
+ * //responses are kept in the HttpCache, a request for a fresh cached response is done as soon as it is created
 */
 
 class HttpReq
 {
 public:
 	HttpReq(const std::string& url);
+	HttpReq(const std::string& url, const std::string& saveAs); // saveAs is only replaced once the request succeeds
 
 	~HttpReq();
 
@@ -40,32 +47,50 @@ public:
 		REQ_INVALID_RESPONSE	//the HTTP response was invalid
 	};
 
-	Status status(); //process any received data and return the status afterwards
+	inline Status status() { return mStatus; }
+	Status wait(); //blocks until the request is done
 
 	std::string getErrorMsg();
 
-	std::string getContent() const; // mStatus must be REQ_SUCCESS
+	std::string getContent() const; // mStatus must be REQ_SUCCESS, empty when saved to a file
 
 	static std::string urlEncode(const std::string &s);
 	static bool isUrl(const std::string& s);
 
+	static void shutdown(); // stops the network thread before exiting, requests still in progress then never finish
+
 private:
-	static size_t write_content(void* buff, size_t size, size_t nmemb, void* req_ptr);
-	//static int update_progress(void* req_ptr, double dlTotal, double dlNow, double ulTotal, double ulNow);
+	class Network;
 
-	//god dammit libcurl why can't you have some way to check the status of an individual handle
-	//why do I have to handle ALL messages at once
-	static std::map<CURL*, HttpReq*> s_requests;
+	void init(const std::string& url);
+	void onDone(CURLcode result); // called by the network thread
+	bool loadFromCache();
 
-	static CURLM* s_multi_handle;
+	static size_t write_content(void* buff, size_t size, size_t nmemb, void* req_ptr);
+	static size_t write_header(char* buff, size_t size, size_t nitems, void* req_ptr);
+	//static int update_progress(void* req_ptr, double dlTotal, double dlNow, double ulTotal, double ulNow);
 
 	void onError(const char* msg);
 
 	CURL* mHandle;
+	curl_slist* mHeaders;
+
+	std::string mUrl;
+	HttpCache* mCache;
+	HttpCache::Entry mCacheEntry;
+	bool mRevalidating; // mCacheEntry expired and is sent along to be validated
+
+	// from the response headers
+	std::string mEtag;
+	std::string mLastModified;
+	long mMaxAge; // -1 when not given
+	bool mNoStore;
 
-	Status mStatus;
+	std::atomic<Status> mStatus;
 
 	std::stringstream mContent;
+	std::string mSavePath;
+	FILE* mFile;
 	std::string mErrorMsg;
 };
 
@@ -17,6 +17,7 @@ std::vector<const char*> settings_dont_save {
 	"DebugGrid",
 	"DebugText",
 	"DebugImage",
+	"FrameTimesCSV",
 	"ForceKid",
 	"ForceKiosk",
 	"IgnoreGamelist",
@@ -85,12 +86,18 @@ void Settings::setDefaults()
 	mBoolMap["DebugGrid"] = false;
 	mBoolMap["DebugText"] = false;
 	mBoolMap["DebugImage"] = false;
+	mStringMap["FrameTimesCSV"] = "";
 
 	mIntMap["ScreenSaverTime"] = 5 * Settings::ONE_MINUTE_IN_MS;
 	mIntMap["SystemSleepTime"] = 0 * Settings::ONE_MINUTE_IN_MS;
 	mBoolMap["SystemSleepTimeHintDisplayed"] = false;
 	mIntMap["ScraperResizeWidth"] = 400;
 	mIntMap["ScraperResizeHeight"] = 0;
+	mIntMap["ScraperMaxRequestsPerHost"] = 4;
+	mIntMap["ScraperRequestInterval"] = 0; // minimum milliseconds between two requests to the same host
+	mBoolMap["HttpCache"] = true;
+	mIntMap["HttpCacheTTL"] = 7 * 24 * 60 * 60; // seconds a response is used before asking the server again
+	mIntMap["HttpCacheMaxSize"] = 100; // megabytes
 	#ifdef _RPI_
 		mIntMap["MaxVRAM"] = 80;
 	#else
@@ -101,6 +108,7 @@ void Settings::setDefaults()
 	mStringMap["ThemeSet"] = "";
 	mStringMap["ScreenSaverBehavior"] = "dim";
 	mStringMap["Scraper"] = "TheGamesDB";
+	mStringMap["ScraperServer"] = ""; // e.g. "http://127.0.0.1:8080", replaces the scrapers' own servers
 	mStringMap["GamelistViewStyle"] = "automatic";
 	mStringMap["SaveGamelistsMode"] = "on exit";
 
@@ -221,6 +229,10 @@ void Settings::saveFile()
 	//saveMap<std::string, std::string>(doc, mStringMap, "string");
 	for(auto iter = mStringMap.cbegin(); iter != mStringMap.cend(); iter++)
 	{
+		// key is on the "don't save" list, so don't save it
+		if(std::find(settings_dont_save.cbegin(), settings_dont_save.cend(), iter->first) != settings_dont_save.cend())
+			continue;
+
 		pugi::xml_node node = doc.append_child("string");
 		node.append_attribute("name").set_value(iter->first.c_str());
 		node.append_attribute("value").set_value(iter->second.c_str());
@@ -3,6 +3,7 @@
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
 #include "resources/Font.h"
+#include "resources/TextureData.h"
 #include "resources/TextureResource.h"
 #include "Log.h"
 #include "Scripting.h"
@@ -10,20 +11,33 @@
 #include <iomanip>
 #include <fcntl.h>
 #include <unistd.h>
+#include <SDL_timer.h>
 
 #ifdef WIN32
 #include <SDL_events.h>
 #endif
 
+// a frame is over budget once it missed at least one vsync at 60Hz
+#define FRAME_BUDGET_MS (1000.0f / 60.0f * 1.5f)
+
+static const char* framePhaseNames[FRAME_PHASE_COUNT] = { "input", "update", "render", "swap", "upload" };
+
 Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL)
+	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL),
+	mFrameTimeIndex(0), mFrameTimeCount(0), mFrameNumber(0), mFramePhaseStart(0), mLongFrameCount(0), mFrameTimeCSV(NULL)
 {
 	mHelp = new HelpComponent(this);
 	mBackgroundOverlay = new ImageComponent(this);
+
+	memset(&mCurrentFrameTime, 0, sizeof(mCurrentFrameTime));
+	memset(mLongFramePhaseCount, 0, sizeof(mLongFramePhaseCount));
 }
 
 Window::~Window()
 {
+	if(mFrameTimeCSV)
+		fclose(mFrameTimeCSV);
+
 	delete mBackgroundOverlay;
 
 	// delete all our GUIs
@@ -184,6 +198,9 @@ void Window::update(int deltaTime)
 			ss << std::fixed << std::setprecision(1) << (1000.0f * (float)mFrameCountElapsed / (float)mFrameTimeElapsed) << "fps, ";
 			ss << std::fixed << std::setprecision(2) << ((float)mFrameTimeElapsed / (float)mFrameCountElapsed) << "ms";
 
+			// frame time percentiles and long frames
+			ss << getFrameTimeText();
+
 			// vram
 			float textureVramUsageMb = TextureResource::getTotalMemUsage() / 1000.0f / 1000.0f;
 			float textureTotalUsageMb = TextureResource::getTotalTextureSize() / 1000.0f / 1000.0f;
@@ -294,6 +311,7 @@ void Window::render()
 	{
 		Renderer::setMatrix(Transform4x4f::Identity());
 		mDefaultFonts.at(1)->renderTextCache(mFrameDataText.get());
+		renderFrameTimeGraph();
 	}
 	
 	if(mCapacityText)
@@ -325,6 +343,130 @@ void Window::render()
 	}
 }
 
+void Window::beginFramePhase(FramePhase phase)
+{
+	mFramePhaseStart = SDL_GetPerformanceCounter();
+}
+
+void Window::endFramePhase(FramePhase phase)
+{
+	mCurrentFrameTime.phases[phase] += (float)((SDL_GetPerformanceCounter() - mFramePhaseStart) * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+void Window::endFrame()
+{
+	FrameTime& frame = mCurrentFrameTime;
+
+	// texture uploads happen while rendering, move them out of the render phase
+	frame.phases[FRAME_PHASE_TEXTURE_UPLOAD] = (float)TextureData::getUploadTimeAndReset();
+	frame.phases[FRAME_PHASE_RENDER] = Math::max(0.0f, frame.phases[FRAME_PHASE_RENDER] - frame.phases[FRAME_PHASE_TEXTURE_UPLOAD]);
+
+	frame.total = 0.0f;
+	for(int i = 0; i < FRAME_PHASE_COUNT; i++)
+		frame.total += frame.phases[i];
+
+	if(frame.total > FRAME_BUDGET_MS)
+	{
+		// attribute the long frame to the phase that took the most time
+		int longestPhase = 0;
+		for(int i = 1; i < FRAME_PHASE_COUNT; i++)
+		{
+			if(frame.phases[i] > frame.phases[longestPhase])
+				longestPhase = i;
+		}
+
+		mLongFrameCount++;
+		mLongFramePhaseCount[longestPhase]++;
+
+		LOG(LogDebug) << "Window::endFrame() - long frame " << mFrameNumber << ": " << frame.total << "ms, mostly " << framePhaseNames[longestPhase];
+	}
+
+	mFrameTimes[mFrameTimeIndex] = frame;
+	mFrameTimeIndex = (mFrameTimeIndex + 1) % FRAME_HISTORY_SIZE;
+	if(mFrameTimeCount < FRAME_HISTORY_SIZE)
+		mFrameTimeCount++;
+
+	writeFrameTimeCSV(frame);
+
+	mFrameNumber++;
+	memset(&mCurrentFrameTime, 0, sizeof(mCurrentFrameTime));
+}
+
+std::string Window::getFrameTimeText()
+{
+	if(!mFrameTimeCount)
+		return "";
+
+	std::vector<float> totals;
+	totals.reserve(mFrameTimeCount);
+	for(int i = 0; i < mFrameTimeCount; i++)
+		totals.push_back(mFrameTimes[i].total);
+
+	std::sort(totals.begin(), totals.end());
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(1);
+	ss << "\np50 " << totals[(totals.size() - 1) * 50 / 100] << "ms p95 " << totals[(totals.size() - 1) * 95 / 100] << "ms p99 " << totals[(totals.size() - 1) * 99 / 100] << "ms max " << totals.back() << "ms";
+	ss << "\nLong frames: " << mLongFrameCount;
+
+	for(int i = 0; i < FRAME_PHASE_COUNT; i++)
+		ss << " " << framePhaseNames[i] << " " << mLongFramePhaseCount[i];
+
+	return ss.str();
+}
+
+void Window::renderFrameTimeGraph()
+{
+	const float barWidth = 2.0f;
+	const float scale = 2.0f; // pixels per millisecond
+	const float maxHeight = 100.0f * scale;
+	const float x = 50.0f;
+	const float y = Renderer::getScreenHeight() - 50.0f;
+
+	Renderer::setMatrix(Transform4x4f::Identity());
+	Renderer::drawRect(x, y - maxHeight, barWidth * FRAME_HISTORY_SIZE, maxHeight, 0x00000080, 0x00000080);
+
+	// oldest frame on the left, newest on the right
+	for(int i = 0; i < mFrameTimeCount; i++)
+	{
+		const FrameTime& frame = mFrameTimes[(mFrameTimeIndex - mFrameTimeCount + i + FRAME_HISTORY_SIZE) % FRAME_HISTORY_SIZE];
+		const float height = Math::min(frame.total * scale, maxHeight);
+		const unsigned int color = (frame.total > FRAME_BUDGET_MS) ? 0xFF0000FF : 0x00FF00FF;
+
+		Renderer::drawRect(x + i * barWidth, y - height, barWidth, height, color, color);
+	}
+
+	Renderer::drawRect(x, y - FRAME_BUDGET_MS * scale, barWidth * FRAME_HISTORY_SIZE, 1.0f, 0xFFFF00FF, 0xFFFF00FF);
+}
+
+void Window::writeFrameTimeCSV(const FrameTime& frame)
+{
+	if(!mFrameTimeCSV)
+	{
+		const std::string path = Settings::getInstance()->getString("FrameTimesCSV");
+		if(path.empty())
+			return;
+
+		mFrameTimeCSV = fopen(path.c_str(), "w");
+		if(!mFrameTimeCSV)
+		{
+			LOG(LogError) << "Could not open frame time file \"" << path << "\"";
+			Settings::getInstance()->setString("FrameTimesCSV", "");
+			return;
+		}
+
+		fprintf(mFrameTimeCSV, "frame,total");
+		for(int i = 0; i < FRAME_PHASE_COUNT; i++)
+			fprintf(mFrameTimeCSV, ",%s", framePhaseNames[i]);
+		fprintf(mFrameTimeCSV, "\n");
+	}
+
+	fprintf(mFrameTimeCSV, "%u,%.3f", mFrameNumber, frame.total);
+	for(int i = 0; i < FRAME_PHASE_COUNT; i++)
+		fprintf(mFrameTimeCSV, ",%.3f", frame.phases[i]);
+	fprintf(mFrameTimeCSV, "\n");
+}
+
 void Window::normalizeNextUpdate()
 {
 	mNormalizeNextUpdate = true;
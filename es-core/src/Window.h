@@ -7,6 +7,7 @@
 #include "Settings.h"
 
 #include <memory>
+#include <stdio.h>
 
 class SystemData;
 class FileData;
@@ -19,6 +20,16 @@ class TextCache;
 class Transform4x4f;
 struct HelpStyle;
 
+enum FramePhase
+{
+	FRAME_PHASE_INPUT,
+	FRAME_PHASE_UPDATE,
+	FRAME_PHASE_RENDER,
+	FRAME_PHASE_SWAP,
+	FRAME_PHASE_TEXTURE_UPLOAD,
+	FRAME_PHASE_COUNT
+};
+
 class Window
 {
 public:
@@ -77,7 +88,24 @@ public:
 	bool cancelScreenSaver();
 	void renderScreenSaver();
 
+	// frame time accounting, the main loop wraps each phase of a frame and calls endFrame() after the swap
+	void beginFramePhase(FramePhase phase);
+	void endFramePhase(FramePhase phase);
+	void endFrame();
+
 private:
+	struct FrameTime
+	{
+		float total;
+		float phases[FRAME_PHASE_COUNT];
+	};
+
+	static const int FRAME_HISTORY_SIZE = 240;
+
+	std::string getFrameTimeText();
+	void renderFrameTimeGraph();
+	void writeFrameTimeCSV(const FrameTime& frame);
+
 	void onSleep();
 	void onWake();
 
@@ -100,6 +128,16 @@ private:
 
 	std::unique_ptr<TextCache> mFrameDataText;
 
+	FrameTime mFrameTimes[FRAME_HISTORY_SIZE];
+	FrameTime mCurrentFrameTime;
+	int mFrameTimeIndex;
+	int mFrameTimeCount;
+	unsigned int mFrameNumber;
+	unsigned long long mFramePhaseStart;
+	unsigned int mLongFrameCount;
+	unsigned int mLongFramePhaseCount[FRAME_PHASE_COUNT];
+	FILE* mFrameTimeCSV;
+
 	bool mNormalizeNextUpdate;
 
 	bool mAllowSleep;
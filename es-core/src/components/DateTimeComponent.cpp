@@ -23,6 +23,12 @@ void DateTimeComponent::setValue(const std::string& val)
 	onTextChanged();
 }
 
+void DateTimeComponent::setTime(const time_t& time)
+{
+	mTime.setTime(time);
+	onTextChanged();
+}
+
 std::string DateTimeComponent::getValue() const
 {
 	return mTime;
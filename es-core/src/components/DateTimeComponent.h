@@ -19,6 +19,7 @@ public:
 
 	void setValue(const std::string& val) override;
 	std::string getValue() const override;
+	void setTime(const time_t& time); // same as setValue() without parsing the ISO string
 
 	void setFormat(const std::string& format);
 	void setDisplayRelative(bool displayRelative);
@@ -178,6 +178,18 @@ public:
 		mEntries.push_back(e);
 	}
 
+	void insert(const Entry& e, int index)
+	{
+		if(index > size())
+			index = size();
+
+		// keep the cursor on the same entry
+		if(!mEntries.empty() && index <= mCursor)
+			mCursor++;
+
+		mEntries.insert(mEntries.cbegin() + index, e);
+	}
+
 	bool remove(const UserData& obj)
 	{
 		for(auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
@@ -51,6 +51,8 @@ public:
 	ImageGridComponent(Window* window);
 
 	void add(const std::string& name, const std::string& imagePath, const T& obj);
+	void insert(const std::string& name, const std::string& imagePath, const T& obj, int index);
+	bool remove(const T& obj);
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
@@ -150,6 +152,25 @@ void ImageGridComponent<T>::add(const std::string& name, const std::string& imag
 	mEntriesDirty = true;
 }
 
+template<typename T>
+void ImageGridComponent<T>::insert(const std::string& name, const std::string& imagePath, const T& obj, int index)
+{
+	typename IList<ImageGridData, T>::Entry entry;
+	entry.name = name;
+	entry.object = obj;
+	entry.data.texturePath = imagePath;
+
+	static_cast<IList< ImageGridData, T >*>(this)->insert(entry, index);
+	mEntriesDirty = true;
+}
+
+template<typename T>
+bool ImageGridComponent<T>::remove(const T& obj)
+{
+	mEntriesDirty = true;
+	return static_cast<IList< ImageGridData, T >*>(this)->remove(obj);
+}
+
 template<typename T>
 bool ImageGridComponent<T>::input(InputConfig* config, Input input)
 {
@@ -62,6 +62,21 @@ namespace Renderer
 
 	}; // Vertex
 
+#if defined(USE_NULL_RENDERER)
+	struct Stats
+	{
+		unsigned long long drawCalls;
+		unsigned long long vertices;
+		unsigned long long stateChanges;
+		unsigned long long textureUploads;
+		unsigned long long uploadedBytes;
+
+	}; // Stats
+
+	// counters of the last presented frame
+	const Stats& getStats();
+#endif // USE_NULL_RENDERER
+
 	bool        init            ();
 	void        deinit          ();
 	void        pushClipRect    (const Vector2i& _pos, const Vector2i& _size);
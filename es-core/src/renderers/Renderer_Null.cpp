@@ -0,0 +1,304 @@
+#if defined(USE_NULL_RENDERER)
+
+#include "renderers/Renderer.h"
+#include "math/Transform4x4f.h"
+#include "Log.h"
+
+#include <string.h>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Renderer
+{
+	struct NullTexture
+	{
+		Texture::Type              type;
+		unsigned int               width;
+		unsigned int               height;
+		std::vector<unsigned char> data;
+
+	}; // NullTexture
+
+//////////////////////////////////////////////////////////////////////////
+
+	static std::vector<NullTexture*> textures;
+	static std::vector<unsigned int> freeTextures;
+	static unsigned int              boundTexture = 0;
+	static unsigned int              blendFactors = 0;
+	static Stats                     frameStats;
+	static Stats                     lastFrameStats;
+	static Stats                     totalStats;
+	static unsigned int              frameCount   = 0;
+
+//////////////////////////////////////////////////////////////////////////
+
+	static unsigned int getBytesPerPixel(const Texture::Type _type)
+	{
+		switch(_type)
+		{
+			case Texture::RGBA:  { return 4; } break;
+			case Texture::ALPHA: { return 1; } break;
+			default:             { return 0; }
+		}
+
+	} // getBytesPerPixel
+
+//////////////////////////////////////////////////////////////////////////
+
+	static void setBlendFunc(const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		const unsigned int factors = (_srcBlendFactor << 16) | _dstBlendFactor;
+
+		if(factors != blendFactors)
+		{
+			blendFactors = factors;
+			frameStats.stateChanges++;
+		}
+
+	} // setBlendFunc
+
+//////////////////////////////////////////////////////////////////////////
+
+	static void accumulateStats(Stats& _total, const Stats& _frame)
+	{
+		_total.drawCalls      += _frame.drawCalls;
+		_total.vertices       += _frame.vertices;
+		_total.stateChanges   += _frame.stateChanges;
+		_total.textureUploads += _frame.textureUploads;
+		_total.uploadedBytes  += _frame.uploadedBytes;
+
+	} // accumulateStats
+
+//////////////////////////////////////////////////////////////////////////
+
+	const Stats& getStats()
+	{
+		return lastFrameStats;
+
+	} // getStats
+
+//////////////////////////////////////////////////////////////////////////
+
+	unsigned int convertColor(const unsigned int _color)
+	{
+		return _color;
+
+	} // convertColor
+
+//////////////////////////////////////////////////////////////////////////
+
+	unsigned int getWindowFlags()
+	{
+		// no GL context is ever created, this also allows the SDL "dummy" video driver to be used
+		return 0;
+
+	} // getWindowFlags
+
+//////////////////////////////////////////////////////////////////////////
+
+	void setupWindow()
+	{
+	} // setupWindow
+
+//////////////////////////////////////////////////////////////////////////
+
+	void createContext()
+	{
+		LOG(LogInfo) << "Null renderer, nothing will be drawn";
+
+		memset(&frameStats, 0, sizeof(frameStats));
+		memset(&lastFrameStats, 0, sizeof(lastFrameStats));
+		memset(&totalStats, 0, sizeof(totalStats));
+		frameCount = 0;
+
+	} // createContext
+
+//////////////////////////////////////////////////////////////////////////
+
+	void destroyContext()
+	{
+		if(frameCount)
+		{
+			LOG(LogInfo) << "Null renderer: " << frameCount << " frames, per frame average of " <<
+				(totalStats.drawCalls / frameCount) << " draw calls, " <<
+				(totalStats.vertices / frameCount) << " vertices, " <<
+				(totalStats.stateChanges / frameCount) << " state changes, " <<
+				(totalStats.textureUploads / frameCount) << " texture uploads (" << (totalStats.uploadedBytes / frameCount) << " bytes)";
+		}
+
+		for(NullTexture* texture : textures)
+			delete texture;
+
+		textures.clear();
+		freeTextures.clear();
+		boundTexture = 0;
+		blendFactors = 0;
+
+	} // destroyContext
+
+//////////////////////////////////////////////////////////////////////////
+
+	unsigned int createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, const void* _data)
+	{
+		NullTexture* texture = new NullTexture;
+		texture->type        = _type;
+		texture->width       = _width;
+		texture->height      = _height;
+		texture->data.resize(_width * _height * getBytesPerPixel(_type));
+
+		if(_data)
+		{
+			memcpy(texture->data.data(), _data, texture->data.size());
+
+			frameStats.textureUploads++;
+			frameStats.uploadedBytes += texture->data.size();
+		}
+
+		// texture 0 means "no texture" so ids are offset by one
+		unsigned int id;
+
+		if(!freeTextures.empty())
+		{
+			id = freeTextures.back();
+			freeTextures.pop_back();
+			textures[id - 1] = texture;
+		}
+		else
+		{
+			textures.push_back(texture);
+			id = (unsigned int)textures.size();
+		}
+
+		return id;
+
+	} // createTexture
+
+//////////////////////////////////////////////////////////////////////////
+
+	void destroyTexture(const unsigned int _texture)
+	{
+		if(_texture == 0 || _texture > textures.size() || !textures[_texture - 1])
+			return;
+
+		delete textures[_texture - 1];
+		textures[_texture - 1] = nullptr;
+		freeTextures.push_back(_texture);
+
+		if(boundTexture == _texture)
+			boundTexture = 0;
+
+	} // destroyTexture
+
+//////////////////////////////////////////////////////////////////////////
+
+	void updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, const void* _data)
+	{
+		if(_texture == 0 || _texture > textures.size() || !textures[_texture - 1] || !_data)
+			return;
+
+		NullTexture*       texture = textures[_texture - 1];
+		const unsigned int bpp     = getBytesPerPixel(_type);
+
+		if((_x + _width) > texture->width || (_y + _height) > texture->height || bpp != getBytesPerPixel(texture->type))
+		{
+			LOG(LogError) << "Null renderer: texture update out of bounds";
+			return;
+		}
+
+		for(unsigned int y = 0; y < _height; ++y)
+			memcpy(&texture->data[((_y + y) * texture->width + _x) * bpp], (const unsigned char*)_data + (y * _width * bpp), _width * bpp);
+
+		frameStats.textureUploads++;
+		frameStats.uploadedBytes += _width * _height * bpp;
+
+	} // updateTexture
+
+//////////////////////////////////////////////////////////////////////////
+
+	void bindTexture(const unsigned int _texture)
+	{
+		if(_texture != boundTexture)
+		{
+			boundTexture = _texture;
+			frameStats.stateChanges++;
+		}
+
+	} // bindTexture
+
+//////////////////////////////////////////////////////////////////////////
+
+	void drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		setBlendFunc(_srcBlendFactor, _dstBlendFactor);
+
+		frameStats.drawCalls++;
+		frameStats.vertices += _numVertices;
+
+	} // drawLines
+
+//////////////////////////////////////////////////////////////////////////
+
+	void drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		setBlendFunc(_srcBlendFactor, _dstBlendFactor);
+
+		frameStats.drawCalls++;
+		frameStats.vertices += _numVertices;
+
+	} // drawTriangleStrips
+
+//////////////////////////////////////////////////////////////////////////
+
+	void setProjection(const Transform4x4f& _projection)
+	{
+		frameStats.stateChanges++;
+
+	} // setProjection
+
+//////////////////////////////////////////////////////////////////////////
+
+	void setMatrix(const Transform4x4f& _matrix)
+	{
+		frameStats.stateChanges++;
+
+	} // setMatrix
+
+//////////////////////////////////////////////////////////////////////////
+
+	void setViewport(const Rect& _viewport)
+	{
+		frameStats.stateChanges++;
+
+	} // setViewport
+
+//////////////////////////////////////////////////////////////////////////
+
+	void setScissor(const Rect& _scissor)
+	{
+		frameStats.stateChanges++;
+
+	} // setScissor
+
+//////////////////////////////////////////////////////////////////////////
+
+	void setSwapInterval()
+	{
+		// there is nothing to synchronize with, frames are as fast as the UI code allows
+	} // setSwapInterval
+
+//////////////////////////////////////////////////////////////////////////
+
+	void swapBuffers()
+	{
+		accumulateStats(totalStats, frameStats);
+		lastFrameStats = frameStats;
+		frameCount++;
+
+		memset(&frameStats, 0, sizeof(frameStats));
+
+	} // swapBuffers
+
+} // Renderer::
+
+#endif // USE_NULL_RENDERER
@@ -1,10 +1,14 @@
 #include "ResourceManager.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/MappedFile.h"
 #include <fstream>
+#include <sys/stat.h>
 
 auto array_deleter = [](unsigned char* p) { delete[] p; };
-auto nop_deleter = [](unsigned char* /*p*/) { };
+
+// mappings of files nobody uses anymore are forgotten once there are that many
+#define MAPPED_FILES_SWEEP_SIZE 256
 
 std::shared_ptr<ResourceManager> ResourceManager::sInstance = nullptr;
 
@@ -25,42 +29,60 @@ std::string ResourceManager::getResourcePath(const std::string& path) const
 	// check if this is a resource file
 	if((path[0] == ':') && (path[1] == '/'))
 	{
-		std::string test;
-
-		// check in homepath
-		test = Utils::FileSystem::getHomePath() + "/configs/emulationstation/resources/" + &path[2];
-		if(Utils::FileSystem::exists(test))
-			return test;
-
-		// check in exepath
-		test = Utils::FileSystem::getExePath() + "/resources/" + &path[2];
-		if(Utils::FileSystem::exists(test))
-			return test;
-
-		// check in cwd
-		test = Utils::FileSystem::getCWDPath() + "/resources/" + &path[2];
-		if(Utils::FileSystem::exists(test))
-			return test;
+		// only looked for once, resources don't come and go while running
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			auto it = mResourcePaths.find(path);
+			if(it != mResourcePaths.cend())
+				return it->second;
+		}
+
+		const std::string resolved = findResource(path);
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mResourcePaths[path] = resolved;
+		return resolved;
 	}
 
 	// not a resource, return unmodified path
 	return path;
 }
 
+std::string ResourceManager::findResource(const std::string& path) const
+{
+	std::string test;
+
+	// check in homepath
+	test = Utils::FileSystem::getHomePath() + "/configs/emulationstation/resources/" + &path[2];
+	if(Utils::FileSystem::exists(test))
+		return test;
+
+	// check in exepath
+	test = Utils::FileSystem::getExePath() + "/resources/" + &path[2];
+	if(Utils::FileSystem::exists(test))
+		return test;
+
+	// check in cwd
+	test = Utils::FileSystem::getCWDPath() + "/resources/" + &path[2];
+	if(Utils::FileSystem::exists(test))
+		return test;
+
+	// not found, return unmodified path
+	return path;
+}
+
 const ResourceData ResourceManager::getFileData(const std::string& path) const
 {
 	//check if its a resource
 	const std::string respath = getResourcePath(path);
 
-	if(Utils::FileSystem::exists(respath))
-	{
-		ResourceData data = loadFile(respath);
-		return data;
-	}
+	//bundled resources are mapped and shared, they are only replaced by reinstalling
+	//anything else (artwork, theme files) may be rewritten in place while in use, which would crash readers of a mapping
+	//if the file doesn't exist, an "empty" ResourceData is returned
+	if(respath != path)
+		return mapFile(respath);
 
-	//if the file doesn't exist, return an "empty" ResourceData
-	ResourceData data = {NULL, 0};
-	return data;
+	return loadFile(respath);
 }
 
 ResourceData ResourceManager::loadFile(const std::string& path) const
@@ -86,6 +108,58 @@ ResourceData ResourceManager::loadFile(const std::string& path) const
 	return ret;
 }
 
+ResourceData ResourceManager::mapFile(const std::string& path) const
+{
+	struct stat info;
+	if(stat(path.c_str(), &info) != 0 || info.st_size <= 0)
+	{
+		//error reading file, return an "empty" ResourceData
+		ResourceData ret = {NULL, 0};
+		return ret;
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	//still mapped for someone else, a font loaded at another size or the same svg for another texture
+	std::shared_ptr<Utils::MappedFile> file;
+	auto it = mMappedFiles.find(path);
+	if(it != mMappedFiles.cend() && it->second.modified == info.st_mtime && it->second.size == (size_t)info.st_size &&
+		it->second.inode == (unsigned long long)info.st_ino)
+		file = it->second.file.lock();
+
+	if(!file)
+	{
+		file = std::make_shared<Utils::MappedFile>();
+		if(!file->open(path))
+		{
+			ResourceData ret = {NULL, 0};
+			return ret;
+		}
+
+		if(mMappedFiles.size() >= MAPPED_FILES_SWEEP_SIZE)
+		{
+			for(auto sweep = mMappedFiles.begin(); sweep != mMappedFiles.end(); )
+			{
+				if(sweep->second.file.expired())
+					sweep = mMappedFiles.erase(sweep);
+				else
+					sweep++;
+			}
+		}
+
+		MappedResource& mapped = mMappedFiles[path];
+		mapped.file = file;
+		mapped.modified = info.st_mtime;
+		mapped.size = (size_t)info.st_size;
+		mapped.inode = (unsigned long long)info.st_ino;
+	}
+
+	//the data is owned by the mapping, it is unmapped with the last ResourceData using it
+	std::shared_ptr<unsigned char> data(file, (unsigned char*)file->getData());
+	ResourceData ret = {data, file->getSize()};
+	return ret;
+}
+
 bool ResourceManager::fileExists(const std::string& path) const
 {
 	//if it exists as a resource file, return true
@@ -3,13 +3,19 @@
 #define ES_CORE_RESOURCES_RESOURCE_MANAGER_H
 
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <time.h>
 
 //The ResourceManager exists to...
 //Allow loading resources embedded into the executable like an actual file.
 //Allow embedded resources to be optionally remapped to actual files for further customization.
 
+namespace Utils { class MappedFile; }
+
+// For a bundled resource, ptr points into a read-only mapping of the file, shared by everything loading it at the same time
 struct ResourceData
 {
 	const std::shared_ptr<unsigned char> ptr;
@@ -44,7 +50,9 @@ private:
 
 	static std::shared_ptr<ResourceManager> sInstance;
 
+	std::string findResource(const std::string& path) const;
 	ResourceData loadFile(const std::string& path) const;
+	ResourceData mapFile(const std::string& path) const;
 
 	class ReloadableInfo
 	{
@@ -54,6 +62,18 @@ private:
 	};
 
 	std::list<std::shared_ptr<ReloadableInfo>> mReloadables; //  std::weak_ptr<IReloadable>
+
+	struct MappedResource
+	{
+		std::weak_ptr<Utils::MappedFile> file;
+		time_t modified; // a file replaced since is mapped again
+		size_t size;
+		unsigned long long inode;
+	};
+
+	mutable std::mutex mMutex; // files are loaded by the texture loader thread too
+	mutable std::map<std::string, std::string> mResourcePaths; // ":/..." -> where it was found
+	mutable std::map<std::string, MappedResource> mMappedFiles;
 };
 
 #endif // ES_CORE_RESOURCES_RESOURCE_MANAGER_H
@@ -7,11 +7,14 @@
 #include "Log.h"
 #include <nanosvg/nanosvg.h>
 #include <nanosvg/nanosvgrast.h>
+#include <SDL_timer.h>
 #include <assert.h>
 #include <string.h>
 
 #define DPI 96
 
+double TextureData::sUploadTime = 0.0;
+
 TextureData::TextureData(bool tile) : mTile(tile), mTextureID(0), mDataRGBA(nullptr), mScalable(false),
 									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f)
 {
@@ -167,11 +170,20 @@ bool TextureData::uploadAndBind()
 			return false;
 
 		// Upload texture
+		const Uint64 start = SDL_GetPerformanceCounter();
 		mTextureID = Renderer::createTexture(Renderer::Texture::RGBA, true, mTile, (int)mWidth, (int)mHeight, mDataRGBA);
+		sUploadTime += (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
 	}
 	return true;
 }
 
+double TextureData::getUploadTimeAndReset()
+{
+	const double uploadTime = sUploadTime;
+	sUploadTime = 0.0;
+	return uploadTime;
+}
+
 void TextureData::releaseVRAM()
 {
 	std::unique_lock<std::mutex> lock(mMutex);
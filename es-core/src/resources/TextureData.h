@@ -47,7 +47,13 @@ public:
 
 	bool tiled() { return mTile; }
 
+	// Time in milliseconds spent uploading textures to VRAM since the last call
+	static double getUploadTimeAndReset();
+
 private:
+	static double	sUploadTime;
+
+
 	std::mutex		mMutex;
 	bool			mTile;
 	std::string		mPath;
@@ -5,6 +5,7 @@
 
 TextureDataManager		TextureResource::sTextureDataManager;
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
+std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sPathTextureMap;
 std::set<TextureResource*> 	TextureResource::sAllTextures;
 
 TextureResource::TextureResource(const std::string& path, bool tile, bool dynamic) : mTextureData(nullptr), mSize(0.0f, 0.0f), mSourceSize(0.0f, 0.0f), mForceLoad(false)
@@ -104,6 +105,16 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 {
 	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
 
+	// the same path asked for again, by the next cursor move over the same game for instance
+	TextureKeyType pathKey(path, tile);
+	auto foundPath = sPathTextureMap.find(pathKey);
+	if(foundPath != sPathTextureMap.cend())
+	{
+		if(!foundPath->second.expired())
+			return foundPath->second.lock();
+		sPathTextureMap.erase(foundPath);
+	}
+
 	const std::string canonicalPath = Utils::FileSystem::getCanonicalPath(path);
 	if(canonicalPath.empty())
 	{
@@ -117,7 +128,10 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	if(foundTexture != sTextureMap.cend())
 	{
 		if(!foundTexture->second.expired())
+		{
+			sPathTextureMap[pathKey] = foundTexture->second;
 			return foundTexture->second.lock();
+		}
 	}
 
 	// need to create it
@@ -130,6 +144,7 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	{
 		// Probably not. Add it to our map. We don't add SVGs because 2 svgs might be rasterized at different sizes
 		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
+		sPathTextureMap[pathKey] = std::weak_ptr<TextureResource>(tex);
 	}
 
 	// Add it to the reloadable list
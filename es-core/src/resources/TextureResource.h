@@ -54,6 +54,7 @@ private:
 
 	typedef std::pair<std::string, bool> TextureKeyType;
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
+	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sPathTextureMap; // same textures by the path they were asked for, skips canonicalizing it again
 	static std::set<TextureResource*> 	sAllTextures;	// Set of all textures, used for memory management
 };
 
@@ -3,9 +3,12 @@
 #include "utils/FileSystemUtil.h"
 
 #include <sys/stat.h>
+#include <stdio.h>
 #include <string.h>
-#include <map>
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #if defined(_WIN32)
 // because windows...
@@ -32,7 +35,175 @@ namespace Utils
 		static std::recursive_mutex        mutex           = {};
 		static std::string                 homePath        = "";
 		static std::string                 exePath         = "";
-		static std::map<std::string, bool> pathExistsIndex = std::map<std::string, bool>();
+
+//////////////////////////////////////////////////////////////////////////
+
+		// exists() results, spread over shards locked separately so the loader threads, the screensaver's indexing
+		// and the UI rarely wait on each other. A directory listed by getDirContent() keeps the names it contains,
+		// any other path in it is known not to exist without a stat.
+		// Each shard is bounded, past its share the entries not used since its previous sweep are dropped.
+		static const size_t EXISTS_SHARD_COUNT = 16;
+		static const size_t EXISTS_SHARD_BYTES = 512 * 1024;
+		static const size_t EXISTS_ENTRY_BYTES = 64; // estimated overhead of an entry or a listed name
+
+		struct ExistsEntry
+		{
+			bool                            exists     = false;
+			bool                            listed     = false; // names holds the whole directory content
+			bool                            referenced = false; // used since the shard's last sweep
+			size_t                          bytes      = 0;
+			std::unordered_set<std::string> names;
+		};
+
+		struct ExistsShard
+		{
+			std::mutex                                   mutex;
+			std::unordered_map<std::string, ExistsEntry> entries;
+			size_t                                       bytes = 0;
+		};
+
+		static ExistsShard                     existsShards[EXISTS_SHARD_COUNT];
+		static std::atomic<unsigned long long> existsHits(0);
+		static std::atomic<unsigned long long> existsMisses(0);
+
+		static ExistsShard& getExistsShard(const std::string& _path)
+		{
+			return existsShards[std::hash<std::string>()(_path) % EXISTS_SHARD_COUNT];
+
+		} // getExistsShard
+
+		static bool splitExistsPath(const std::string& _path, std::string& _parent, std::string& _name)
+		{
+			const size_t separator = _path.find_last_of('/');
+
+			if((separator == std::string::npos) || (separator + 1 >= _path.size()))
+				return false;
+
+			_parent = (separator == 0) ? "/" : _path.substr(0, separator);
+			_name   = _path.substr(separator + 1);
+
+			return true;
+
+		} // splitExistsPath
+
+		// the shard must be locked
+		static void sweepExistsShard(ExistsShard& _shard)
+		{
+			// an entry used since the previous sweep is only unmarked, unless unmarking everything wasn't enough
+			for(int pass = 0; (pass < 2) && (_shard.bytes > (EXISTS_SHARD_BYTES * 3 / 4)); ++pass)
+			{
+				for(auto it = _shard.entries.begin(); (it != _shard.entries.end()) && (_shard.bytes > (EXISTS_SHARD_BYTES * 3 / 4)); )
+				{
+					if(it->second.referenced)
+					{
+						it->second.referenced = false;
+						++it;
+					}
+					else
+					{
+						_shard.bytes -= it->second.bytes;
+						it = _shard.entries.erase(it);
+					}
+				}
+			}
+
+		} // sweepExistsShard
+
+		// the shard must be locked
+		static void storeExists(ExistsShard& _shard, const std::string& _path, const bool _exists, const std::unordered_set<std::string>* _names)
+		{
+			ExistsEntry& entry = _shard.entries[_path];
+
+			_shard.bytes     -= entry.bytes;
+			entry.exists      = _exists;
+			entry.referenced  = true;
+			entry.listed      = (_names != nullptr);
+			entry.bytes       = _path.size() + EXISTS_ENTRY_BYTES;
+
+			if(_names)
+			{
+				entry.names = *_names;
+				for(auto it = entry.names.cbegin(); it != entry.names.cend(); ++it)
+					entry.bytes += it->size() + EXISTS_ENTRY_BYTES;
+			}
+			else
+			{
+				entry.names.clear();
+			}
+
+			_shard.bytes += entry.bytes;
+
+			if(_shard.bytes > EXISTS_SHARD_BYTES)
+				sweepExistsShard(_shard);
+
+		} // storeExists
+
+		// keeps the parent's listing, if there is one, in line with a change made to _path
+		static void updateExistsListing(const std::string& _path, const bool _exists, const bool _known)
+		{
+			std::string parent;
+			std::string name;
+
+			if(!splitExistsPath(_path, parent, name))
+				return;
+
+			ExistsShard&                       shard = getExistsShard(parent);
+			const std::unique_lock<std::mutex> lock(shard.mutex);
+			auto                               it    = shard.entries.find(parent);
+
+			if((it == shard.entries.end()) || !it->second.listed)
+				return;
+
+			if(!_known)
+			{
+				it->second.listed = false;
+				for(auto name_it = it->second.names.cbegin(); name_it != it->second.names.cend(); ++name_it)
+				{
+					it->second.bytes -= name_it->size() + EXISTS_ENTRY_BYTES;
+					shard.bytes      -= name_it->size() + EXISTS_ENTRY_BYTES;
+				}
+				it->second.names.clear();
+			}
+			else if(_exists && it->second.names.insert(name).second)
+			{
+				it->second.bytes += name.size() + EXISTS_ENTRY_BYTES;
+				shard.bytes      += name.size() + EXISTS_ENTRY_BYTES;
+			}
+			else if(!_exists && (it->second.names.erase(name) > 0))
+			{
+				it->second.bytes -= name.size() + EXISTS_ENTRY_BYTES;
+				shard.bytes      -= name.size() + EXISTS_ENTRY_BYTES;
+			}
+
+		} // updateExistsListing
+
+		// a file was created or removed at _path
+		static void setExists(const std::string& _path, const bool _exists)
+		{
+			{
+				ExistsShard&                       shard = getExistsShard(_path);
+				const std::unique_lock<std::mutex> lock(shard.mutex);
+
+				storeExists(shard, _path, _exists, nullptr);
+			}
+
+			updateExistsListing(_path, _exists, true);
+
+		} // setExists
+
+		static void storeDirContent(const std::string& _path, const std::unordered_set<std::string>& _names)
+		{
+			size_t bytes = _path.size() + EXISTS_ENTRY_BYTES;
+			for(auto it = _names.cbegin(); it != _names.cend(); ++it)
+				bytes += it->size() + EXISTS_ENTRY_BYTES;
+
+			ExistsShard&                       shard = getExistsShard(_path);
+			const std::unique_lock<std::mutex> lock(shard.mutex);
+
+			// a listing too large for the shard would only push everything else out
+			storeExists(shard, _path, true, (bytes <= (EXISTS_SHARD_BYTES / 2)) ? &_names : nullptr);
+
+		} // storeDirContent
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -53,8 +224,9 @@ namespace Utils
 
 		stringList getDirContent(const std::string& _path, const bool _recursive)
 		{
-			const std::string path = getGenericPath(_path);
-			stringList        contentList;
+			const std::string               path = getGenericPath(_path);
+			stringList                      contentList;
+			std::unordered_set<std::string> names;
 
 			// only parse the directory, if it's a directory
 			if(isDirectory(path))
@@ -77,6 +249,7 @@ namespace Utils
 						if((name != ".") && (name != ".."))
 						{
 							const std::string fullName(getGenericPath(path + "/" + name));
+							names.insert(name);
 
 							contentList.push_back(fullName);
 
@@ -104,6 +277,7 @@ namespace Utils
 						if((name != ".") && (name != ".."))
 						{
 							std::string fullName(getGenericPath(path + "/" + name));
+							names.insert(name);
 							contentList.push_back(fullName);
 
 							if(_recursive && isDirectory(fullName))
@@ -115,6 +289,8 @@ namespace Utils
 				}
 #endif // !_WIN32
 
+				// what is in the directory is known now, exists() doesn't need to look at any path in it
+				storeDirContent(path, names);
 			}
 
 			// sort the content list
@@ -331,12 +507,69 @@ namespace Utils
 
 //////////////////////////////////////////////////////////////////////////
 
+		// getCanonicalPath() results for absolute paths, kept as long as the directory containing the path isn't
+		// modified: replacing one of its entries by a symlink or retargeting one changes its mtime, and when it is
+		// a symlink itself it is looked at with lstat so retargeting it is noticed too.
+		// Changes further up the path are not noticed, those directories are hardly ever swapped for symlinks.
+		struct CanonicalEntry
+		{
+			std::string canonical;
+			time_t      parentModified;
+			ino_t       parentInode;
+		};
+
+		static const size_t                                     CANONICAL_CACHE_SIZE = 4096;
+		static std::mutex                                       canonicalMutex;
+		static std::unordered_map<std::string, CanonicalEntry> canonicalCache;
+
+		static std::string resolveCanonicalPath(const std::string& _path);
+
 		std::string getCanonicalPath(const std::string& _path)
 		{
 			// temporary hack for builtin resources
 			if((_path[0] == ':') && (_path[1] == '/'))
 				return _path;
 
+			// a relative path depends on the working directory
+			if(!isAbsolute(_path))
+				return resolveCanonicalPath(_path);
+
+			struct stat64 info;
+#if defined(_WIN32)
+			if(stat64(getParent(getGenericPath(_path)).c_str(), &info) != 0)
+#else // _WIN32
+			if(lstat64(getParent(getGenericPath(_path)).c_str(), &info) != 0)
+#endif // !_WIN32
+				return resolveCanonicalPath(_path);
+
+			{
+				const std::unique_lock<std::mutex> lock(canonicalMutex);
+				auto                               it = canonicalCache.find(_path);
+
+				if((it != canonicalCache.end()) && (it->second.parentModified == info.st_mtime) && (it->second.parentInode == info.st_ino))
+					return it->second.canonical;
+			}
+
+			const std::string canonical = resolveCanonicalPath(_path);
+
+			const std::unique_lock<std::mutex> lock(canonicalMutex);
+
+			if(canonicalCache.size() >= CANONICAL_CACHE_SIZE)
+				canonicalCache.clear();
+
+			CanonicalEntry& entry = canonicalCache[_path];
+			entry.canonical      = canonical;
+			entry.parentModified = info.st_mtime;
+			entry.parentInode    = info.st_ino;
+
+			return canonical;
+
+		} // getCanonicalPath
+
+//////////////////////////////////////////////////////////////////////////
+
+		static std::string resolveCanonicalPath(const std::string& _path)
+		{
 			std::string path = exists(_path) ? getAbsolutePath(_path) : getGenericPath(_path);
 
 			// cleanup path
@@ -398,7 +631,7 @@ namespace Utils
 			// return canonical path
 			return path;
 
-		} // getCanonicalPath
+		} // resolveCanonicalPath
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -609,13 +842,39 @@ namespace Utils
 			
 			// if removed, let's remove it from the index
 			if (removed)
-				pathExistsIndex[_path] = false;
+				setExists(path, false);
 
 			// try to remove file
 			return removed;
 
 		} // removeFile
 
+//////////////////////////////////////////////////////////////////////////
+
+		bool renameFile(const std::string& _from, const std::string& _to)
+		{
+			const std::unique_lock<std::recursive_mutex> lock(mutex);
+			const std::string                            from = getGenericPath(_from);
+			const std::string                            to   = getGenericPath(_to);
+
+#if defined(_WIN32)
+			// rename() doesn't replace an existing file there
+			unlink(to.c_str());
+#endif // _WIN32
+
+			bool renamed = (rename(from.c_str(), to.c_str()) == 0);
+
+			// if renamed, let's update the index
+			if(renamed)
+			{
+				setExists(from, false);
+				setExists(to, true);
+			}
+
+			return renamed;
+
+		} // renameFile
+
 //////////////////////////////////////////////////////////////////////////
 
 		bool createDirectory(const std::string& _path)
@@ -629,7 +888,7 @@ namespace Utils
 			// try to create directory
 			if(mkdir(path.c_str(), 0755) == 0)
 			{
-				pathExistsIndex[_path] = true;
+				setExists(path, true);
 				return true;
 			}
 
@@ -643,7 +902,7 @@ namespace Utils
 			// try to create directory again now that the parent should exist
 			bool created = (mkdir(path.c_str(), 0755) == 0);
 			if(created)
-				pathExistsIndex[_path] = true;
+				setExists(path, true);
 
 			return created;
 
@@ -653,20 +912,130 @@ namespace Utils
 
 		bool exists(const std::string& _path)
 		{
-			const std::unique_lock<std::recursive_mutex> lock(mutex);
+			const std::string path = getGenericPath(_path);
+
+			{
+				ExistsShard&                       shard = getExistsShard(path);
+				const std::unique_lock<std::mutex> lock(shard.mutex);
+				auto                               it    = shard.entries.find(path);
+
+				if(it != shard.entries.end())
+				{
+					it->second.referenced = true;
+					++existsHits;
+					return it->second.exists;
+				}
+			}
+
+			// a path in a listed directory exists only if it was listed
+			std::string parent;
+			std::string name;
 
-			if(pathExistsIndex.find(_path) == pathExistsIndex.cend())
+			if(splitExistsPath(path, parent, name))
 			{
-				const std::string path = getGenericPath(_path);
-				struct stat64 info;
-				// check if stat64 succeeded
-				pathExistsIndex[_path] = (stat64(path.c_str(), &info) == 0);
+				ExistsShard&                       shard = getExistsShard(parent);
+				const std::unique_lock<std::mutex> lock(shard.mutex);
+				auto                               it    = shard.entries.find(parent);
+
+				if((it != shard.entries.end()) && it->second.listed)
+				{
+					it->second.referenced = true;
+					++existsHits;
+					return (it->second.names.find(name) != it->second.names.cend());
+				}
 			}
 
-			return pathExistsIndex.at(_path);
+			++existsMisses;
+
+			// check if stat64 succeeded
+			struct stat64 info;
+			const bool    found = (stat64(path.c_str(), &info) == 0);
+
+			ExistsShard&                       shard = getExistsShard(path);
+			const std::unique_lock<std::mutex> lock(shard.mutex);
+
+			// another thread may have listed it meanwhile, what it found is as recent
+			if(shard.entries.find(path) == shard.entries.end())
+				storeExists(shard, path, found, nullptr);
+
+			return found;
 
 		} // exists
 
+//////////////////////////////////////////////////////////////////////////
+
+		void invalidateExists(const std::string& _path)
+		{
+			const std::string path = getGenericPath(_path);
+
+			{
+				ExistsShard&                       shard = getExistsShard(path);
+				const std::unique_lock<std::mutex> lock(shard.mutex);
+				auto                               it    = shard.entries.find(path);
+
+				if(it != shard.entries.end())
+				{
+					shard.bytes -= it->second.bytes;
+					shard.entries.erase(it);
+				}
+			}
+
+			// whether it is still there isn't known, the parent has to be listed again
+			updateExistsListing(path, false, false);
+
+		} // invalidateExists
+
+//////////////////////////////////////////////////////////////////////////
+
+		void invalidateExistsPrefix(const std::string& _prefix)
+		{
+			const std::string prefix = getGenericPath(_prefix);
+
+			for(size_t i = 0; i < EXISTS_SHARD_COUNT; ++i)
+			{
+				ExistsShard&                       shard = existsShards[i];
+				const std::unique_lock<std::mutex> lock(shard.mutex);
+
+				for(auto it = shard.entries.begin(); it != shard.entries.end(); )
+				{
+					if(it->first.compare(0, prefix.size(), prefix) == 0)
+					{
+						shard.bytes -= it->second.bytes;
+						it = shard.entries.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+
+			updateExistsListing(prefix, false, false);
+
+		} // invalidateExistsPrefix
+
+//////////////////////////////////////////////////////////////////////////
+
+		ExistsCacheStats getExistsCacheStats()
+		{
+			ExistsCacheStats stats;
+			stats.hits    = existsHits;
+			stats.misses  = existsMisses;
+			stats.entries = 0;
+			stats.bytes   = 0;
+
+			for(size_t i = 0; i < EXISTS_SHARD_COUNT; ++i)
+			{
+				const std::unique_lock<std::mutex> lock(existsShards[i].mutex);
+
+				stats.entries += existsShards[i].entries.size();
+				stats.bytes   += existsShards[i].bytes;
+			}
+
+			return stats;
+
+		} // getExistsCacheStats
+
 //////////////////////////////////////////////////////////////////////////
 
 		bool isAbsolute(const std::string& _path)
@@ -11,6 +11,14 @@ namespace Utils
 	{
 		typedef std::list<std::string> stringList;
 
+		struct ExistsCacheStats
+		{
+			unsigned long long hits;    // answered from the cache, a path or its directory's listing
+			unsigned long long misses;  // answered with a stat
+			size_t             entries;
+			size_t             bytes;   // estimated memory used
+		};
+
 		stringList  getDirContent      (const std::string& _path, const bool _recursive = false);
 		stringList  getPathList        (const std::string& _path);
 		void        setHomePath        (const std::string& _path);
@@ -32,8 +40,12 @@ namespace Utils
 		std::string removeCommonPath   (const std::string& _path, const std::string& _common, bool& _contains, const bool _skipDirectoryCheck);
 		std::string resolveSymlink     (const std::string& _path);
 		bool        removeFile         (const std::string& _path);
+		bool        renameFile         (const std::string& _from, const std::string& _to); // replaces _to if it exists
 		bool        createDirectory    (const std::string& _path);
 		bool        exists             (const std::string& _path);
+		void        invalidateExists   (const std::string& _path);   // after changing _path other than with removeFile() or createDirectory()
+		void        invalidateExistsPrefix(const std::string& _prefix); // every path starting with _prefix
+		ExistsCacheStats getExistsCacheStats();
 		bool        isAbsolute         (const std::string& _path);
 		bool        isRegularFile      (const std::string& _path);
 		bool        isDirectory        (const std::string& _path);
@@ -0,0 +1,93 @@
+#include "utils/MappedFile.h"
+
+#include <fstream>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // !_WIN32
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace Utils
+{
+	MappedFile::MappedFile() : mData(nullptr), mSize(0)
+	{
+
+	} // MappedFile
+
+	MappedFile::~MappedFile()
+	{
+		close();
+
+	} // ~MappedFile
+
+	bool MappedFile::open(const std::string& _path)
+	{
+		close();
+
+#if defined(_WIN32)
+		std::ifstream file(_path, std::ios::binary | std::ios::ate);
+		if(!file.good())
+			return false;
+
+		const std::streamoff size = file.tellg();
+		if(size <= 0)
+			return false;
+
+		mBuffer.resize((size_t)size);
+		file.seekg(0);
+		if(!file.read(mBuffer.data(), size))
+		{
+			mBuffer.clear();
+			return false;
+		}
+
+		mData = mBuffer.data();
+		mSize = mBuffer.size();
+#else
+		const int file = ::open(_path.c_str(), O_RDONLY);
+		if(file < 0)
+			return false;
+
+		struct stat info;
+		if(fstat(file, &info) != 0 || info.st_size <= 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		// the mapping keeps the file's content alive even when the file is replaced or removed
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+
+		if(data == MAP_FAILED)
+			return false;
+
+		mData = (const char*)data;
+		mSize = (size_t)info.st_size;
+#endif // _WIN32
+
+		return true;
+
+	} // open
+
+	void MappedFile::close()
+	{
+		if(mData == nullptr)
+			return;
+
+#if defined(_WIN32)
+		mBuffer.clear();
+		mBuffer.shrink_to_fit();
+#else
+		munmap((void*)mData, mSize);
+#endif // _WIN32
+
+		mData = nullptr;
+		mSize = 0;
+
+	} // close
+
+} // Utils::
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef ES_CORE_UTILS_MAPPED_FILE_H
+#define ES_CORE_UTILS_MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	// Read-only view of a whole file, mapped in memory with mmap() so only the pages that are used are read
+	// and they can be dropped again by the system under memory pressure. Read into a buffer where there is no mmap().
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		bool open(const std::string& _path); // false when the file can't be opened or is empty
+		void close();
+
+		inline bool        isOpen() const { return mData != nullptr; }
+		inline const char* getData() const { return mData; }
+		inline size_t      getSize() const { return mSize; }
+
+	private:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char*       mData;
+		size_t            mSize;
+		std::vector<char> mBuffer; // without mmap()
+
+	}; // MappedFile
+
+} // Utils::
+
+#endif // ES_CORE_UTILS_MAPPED_FILE_H
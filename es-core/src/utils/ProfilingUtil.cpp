@@ -7,6 +7,9 @@
 #include "Log.h"
 
 #include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #if defined(_WIN32)
 // because windows...
@@ -22,10 +25,14 @@ namespace Utils
 {
 	namespace Profiling
 	{
-		std::vector<Profile*>     profiles;
-		std::vector<ThreadStack*> threadStacks;
-		std::recursive_mutex      mutex;
-		unsigned int              counter = 0;
+		std::atomic<unsigned int> counter(0);
+
+		static std::vector<ThreadData*> threadDatas;
+		static std::mutex               threadDatasMutex;
+		static thread_local ThreadData* threadData = nullptr;
+
+		// amount of timings kept per profile and thread for the percentile statistics
+		static const size_t maxSamples = 1024;
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -65,68 +72,128 @@ namespace Utils
 
 //////////////////////////////////////////////////////////////////////////
 
-		static bool _sortProfiles(const Profile* _a, const Profile* _b)
+		static ThreadData* getThreadData(void)
 		{
-			return _a->message < _b->message;
+			// the registry is only locked the first time a thread profiles something
+			if(!threadData)
+			{
+				threadData         = new ThreadData;
+				threadData->random = (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id());
 
-		} // _sortProfiles
+				std::unique_lock<std::mutex> lock(threadDatasMutex);
+				threadDatas.push_back(threadData);
+			}
+
+			return threadData;
+
+		} // getThreadData
 
 //////////////////////////////////////////////////////////////////////////
 
-		unsigned int _generateIndex(void)
+		static void addSample(ThreadData* _threadData, Profile* _profile, const double _time)
 		{
-			mutex.lock();
-			unsigned int index = counter++;
-			mutex.unlock();
+			// reservoir sampling, keeps a uniform selection of at most maxSamples timings
+			if(_profile->samples.size() < maxSamples)
+			{
+				_profile->samples.push_back(_time);
+			}
+			else
+			{
+				_threadData->random = _threadData->random * 1664525u + 1013904223u;
 
-			return index;
+				const unsigned int index = _threadData->random % _profile->callCount;
 
-		} // _generateIndex
+				if(index < maxSamples)
+					_profile->samples[index] = _time;
+			}
+
+		} // addSample
 
 //////////////////////////////////////////////////////////////////////////
 
-		void _begin(const unsigned int _index, const std::string& _message)
+		static void resetProfile(Profile* _profile)
+		{
+			// timeBegin is left alone, the profile may be running while _dump resets it
+			_profile->timeTotal    = 0.0;
+			_profile->timeExternal = 0.0;
+			_profile->timeMin      = 999999999.0;
+			_profile->timeMax      = 0.0;
+			_profile->callCount    = 0;
+			_profile->samples.clear();
+
+		} // resetProfile
+
+//////////////////////////////////////////////////////////////////////////
+
+		static double getPercentile(std::vector<std::pair<double, double>>& _samples, const double _percentile)
 		{
-			const std::thread::id threadId    = std::this_thread::get_id();
-			ThreadStack*          threadStack = nullptr;
-			Profile*              profile     = nullptr;
+			if(_samples.empty())
+				return 0.0;
 
-			mutex.lock();
+			double totalWeight = 0.0;
 
-			for( ThreadStack* threadStackIt : threadStacks )
-				if(threadStackIt->id == threadId)
-					threadStack = threadStackIt;
+			for(auto& sample : _samples)
+				totalWeight += sample.second;
 
-			if(!threadStack)
+			const double targetWeight = totalWeight * _percentile;
+			double       weight       = 0.0;
+
+			for(auto& sample : _samples)
 			{
-				threadStack     = new ThreadStack;
-				threadStack->id = threadId;
+				weight += sample.second;
 
-				threadStacks.push_back(threadStack);
+				if(weight >= targetWeight)
+					return sample.first;
 			}
 
-			while(profiles.size() < counter)
+			return _samples.back().first;
+
+		} // getPercentile
+
+//////////////////////////////////////////////////////////////////////////
+
+		static bool _sortProfiles(const Profile& _a, const Profile& _b)
+		{
+			return _a.message < _b.message;
+
+		} // _sortProfiles
+
+//////////////////////////////////////////////////////////////////////////
+
+		unsigned int _generateIndex(void)
+		{
+			return counter++;
+
+		} // _generateIndex
+
+//////////////////////////////////////////////////////////////////////////
+
+		void _begin(const unsigned int _index, const std::string& _message)
+		{
+			ThreadData* data    = getThreadData();
+			Profile*    profile = nullptr;
+
 			{
-				profile               = new Profile;
-				profile->message      = "";
-				profile->timeBegin    = 0.0;
-				profile->timeTotal    = 0.0;
-				profile->timeExternal = 0.0;
-				profile->timeMin      = 999999999.0;
-				profile->timeMax      = 0.0;
-				profile->callCount    = 0;
-
-				profiles.push_back(profile);
-			}
+				std::unique_lock<std::mutex> lock(data->mutex);
 
-			profile = profiles[_index];
+				if(data->profiles.size() <= _index)
+					data->profiles.resize(counter.load(), nullptr);
 
-			threadStack->stack.push(profile);
+				profile = data->profiles[_index];
 
-			profile->message   = _message;
-			profile->timeBegin = getTime();
+				if(!profile)
+				{
+					profile          = new Profile;
+					profile->message = _message;
+					resetProfile(profile);
+
+					data->profiles[_index] = profile;
+				}
+			}
 
-			mutex.unlock();
+			data->stack.push_back(profile);
+
+			profile->timeBegin = getTime();
 
 		} // _begin
 
@@ -134,38 +201,29 @@ namespace Utils
 
 		int _end(void)
 		{
-			const double          timeEnd     = getTime();
-			const std::thread::id threadId    = std::this_thread::get_id();
-			ThreadStack*          threadStack = nullptr;
-			Profile*              profile     = nullptr;
-
-			mutex.lock();
+			const double timeEnd = getTime();
+			ThreadData*  data    = threadData;
+			Profile*     profile = data->stack.back();
 
-			for( ThreadStack* threadStackIt : threadStacks )
-				if(threadStackIt->id == threadId)
-					threadStack = threadStackIt;
-
-			profile = threadStack->stack.top();
-			threadStack->stack.pop();
+			data->stack.pop_back();
 
 			// timer wrapped (~24 days)
 			if(timeEnd < profile->timeBegin)
-			{
-				mutex.unlock();
 				return 0;
-			}
 
 			const double timeElapsed = timeEnd - profile->timeBegin;
 
+			std::unique_lock<std::mutex> lock(data->mutex);
+
 			profile->timeTotal += timeElapsed;
 			profile->timeMin    = (profile->timeMin < timeElapsed) ? profile->timeMin : timeElapsed;
 			profile->timeMax    = (profile->timeMax > timeElapsed) ? profile->timeMax : timeElapsed;
 			profile->callCount++;
 
-			if(!threadStack->stack.empty())
-				threadStack->stack.top()->timeExternal += timeElapsed;
+			addSample(data, profile, timeElapsed);
 
-			mutex.unlock();
+			if(!data->stack.empty())
+				data->stack.back()->timeExternal += timeElapsed;
 
 			return timeElapsed;
 
@@ -175,6 +233,54 @@ namespace Utils
 
 		void _dump(void)
 		{
+			// the registry lock keeps new threads out, every table is then locked while it is merged and reset
+			std::unique_lock<std::mutex> lock(threadDatasMutex);
+
+			std::vector<Profile>                                 profiles(counter.load());
+			std::vector<std::vector<std::pair<double, double>>> samples(profiles.size());
+
+			for(Profile& profile : profiles)
+				resetProfile(&profile);
+
+			for(ThreadData* data : threadDatas)
+			{
+				std::unique_lock<std::mutex> dataLock(data->mutex);
+
+				for(size_t i = 0; i < data->profiles.size() && i < profiles.size(); ++i)
+				{
+					Profile* threadProfile = data->profiles[i];
+
+					if(!threadProfile || !threadProfile->callCount)
+						continue;
+
+					Profile& profile = profiles[i];
+
+					profile.message       = threadProfile->message;
+					profile.timeTotal    += threadProfile->timeTotal;
+					profile.timeExternal += threadProfile->timeExternal;
+					profile.timeMin       = (profile.timeMin < threadProfile->timeMin) ? profile.timeMin : threadProfile->timeMin;
+					profile.timeMax       = (profile.timeMax > threadProfile->timeMax) ? profile.timeMax : threadProfile->timeMax;
+					profile.callCount    += threadProfile->callCount;
+
+					// every sample stands for the calls it was picked from so threads with more calls weigh more
+					const double weight = (double)threadProfile->callCount / threadProfile->samples.size();
+
+					for(double sample : threadProfile->samples)
+						samples[i].push_back(std::make_pair(sample, weight));
+
+					resetProfile(threadProfile);
+				}
+			}
+
+			for(size_t i = 0; i < profiles.size(); ++i)
+			{
+				std::sort(samples[i].begin(), samples[i].end());
+
+				profiles[i].samples.push_back(getPercentile(samples[i], 0.50));
+				profiles[i].samples.push_back(getPercentile(samples[i], 0.95));
+				profiles[i].samples.push_back(getPercentile(samples[i], 0.99));
+			}
+
 			std::sort(profiles.begin(), profiles.end(), _sortProfiles);
 
 			if(!profiles.empty())
@@ -182,38 +288,26 @@ namespace Utils
 				char buffer[1024];
 				int  longestMessage = 0;
 
-				for(Profile* profile : profiles)
-					longestMessage = Math::max(longestMessage, (int)profile->message.length());
+				for(Profile& profile : profiles)
+					longestMessage = Math::max(longestMessage, (int)profile.message.length());
 
 				char format1[1024];
-				snprintf(format1, 1024, "%%-%ds\t%%12s\t%%12s\t%%12s\t%%12s\t%%12s\t%%20s\t%%20s", longestMessage);
+				snprintf(format1, 1024, "%%-%ds\t%%12s\t%%12s\t%%12s\t%%12s\t%%12s\t%%12s\t%%12s\t%%12s\t%%20s\t%%20s", longestMessage);
 
-				snprintf(buffer, 1024, format1, "Message", "Calls", "Total Time", "Avg Time", "Min Time", "Max Time", "Internal Total Time", "Internal Avg Time");
+				snprintf(buffer, 1024, format1, "Message", "Calls", "Total Time", "Avg Time", "Min Time", "Max Time", "P50 Time", "P95 Time", "P99 Time", "Internal Total Time", "Internal Avg Time");
 				LOG(LogDebug) << buffer;
 
 				char format2[1024];
-				snprintf(format2, 1024, "%%-%ds\t%%12d\t%%12.6f\t%%12.6f\t%%12.6f\t%%12.6f\t%%20.6f\t%%20.6f", longestMessage);
+				snprintf(format2, 1024, "%%-%ds\t%%12d\t%%12.6f\t%%12.6f\t%%12.6f\t%%12.6f\t%%12.6f\t%%12.6f\t%%12.6f\t%%20.6f\t%%20.6f", longestMessage);
 
-				for(Profile* profile : profiles)
+				for(Profile& profile : profiles)
 				{
-					if(profile->message.length())
+					if(profile.message.length() && profile.callCount)
 					{
-						snprintf(buffer, 1024, format2, profile->message.c_str(), profile->callCount, profile->timeTotal, profile->timeTotal / profile->callCount, profile->timeMin, profile->timeMax, profile->timeTotal - profile->timeExternal, (profile->timeTotal - profile->timeExternal) / profile->callCount);
+						snprintf(buffer, 1024, format2, profile.message.c_str(), profile.callCount, profile.timeTotal, profile.timeTotal / profile.callCount, profile.timeMin, profile.timeMax, profile.samples[0], profile.samples[1], profile.samples[2], profile.timeTotal - profile.timeExternal, (profile.timeTotal - profile.timeExternal) / profile.callCount);
 						LOG(LogDebug) << buffer;
 					}
-
-					delete profile;
 				}
-
-				profiles.clear();
-			}
-
-			if(!threadStacks.empty())
-			{
-				for(ThreadStack* threadStack : threadStacks)
-					delete threadStack;
-
-				threadStacks.clear();
 			}
 
 		} // _dump
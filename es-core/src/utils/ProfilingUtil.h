@@ -4,10 +4,9 @@
 
 #if defined(USE_PROFILING)
 
+#include <atomic>
 #include <mutex>
-#include <stack>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace Utils
@@ -16,27 +15,29 @@ namespace Utils
 	{
 		struct Profile
 		{
-			std::string  message;
-			double       timeBegin;
-			double       timeTotal;
-			double       timeExternal;
-			double       timeMin;
-			double       timeMax;
-			unsigned int callCount;
+			std::string         message;
+			double              timeBegin;
+			double              timeTotal;
+			double              timeExternal;
+			double              timeMin;
+			double              timeMax;
+			unsigned int        callCount;
+			std::vector<double> samples;
 
 		}; // Profile
 
-		struct ThreadStack
+		// every thread owns its stack and its own table of profiles, the table mutex is only
+		// contended while _dump merges and resets that thread's table
+		struct ThreadData
 		{
-			std::stack<Profile*> stack;
-			std::thread::id      id;
+			std::vector<Profile*> stack;
+			std::vector<Profile*> profiles;
+			std::mutex            mutex;
+			unsigned int          random;
 
-		}; // ThreadStack
+		}; // ThreadData
 
-		extern std::vector<Profile*>     profiles;
-		extern std::vector<ThreadStack*> threadStacks;
-		extern std::recursive_mutex      mutex;
-		extern unsigned int              counter;
+		extern std::atomic<unsigned int> counter;
 
 //////////////////////////////////////////////////////////////////////////
 